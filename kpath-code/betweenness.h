@@ -41,11 +41,16 @@ typedef int i32;
 #include<time.h>
 #include<math.h> 
 #include <limits.h>
-#include "network.h"
+#include <limits>
+#include "csr.h"
+#include "components.h"
+#include "rng.h"
 #include "fibheap.h"
 
 using namespace std;
 
-void BrandesAlgorithm(f64 CB[], NETWORK *network, f64 &time_dif);
+#define BOTTOMUP_SCAN 16		// Vertices a bottom-up search step checks for the cost of following one edge
+
+void BrandesAlgorithm(f64 CB[], CSR *graph, const COMPONENTS *components, f64 &time_dif);
 
 #endif
@@ -0,0 +1,222 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Byte scanning and number parsing helpers for the text readers.
+//
+// The scans work on a [p,end) range of memory and never read past "end",
+// so they can be used directly on a memory-mapped file.  They are
+// vectorized with AVX2 when the compiler targets it (e.g. -mavx2 or
+// -march=native), otherwise with SSE2, and fall back to plain loops on
+// other processors.  The number parsers convert text in place without
+// copying it into a NUL-terminated buffer first.
+
+#ifndef BYTESCAN_H
+#define BYTESCAN_H
+
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define BYTESCAN_AVX2
+#elif defined(__SSE2__)
+#include <emmintrin.h>
+#define BYTESCAN_SSE2
+#endif
+
+// Character classes used by the GML and edge-list tokenizers
+
+static inline int is_space(int c)
+{
+  return (c==' ')||(c=='\t')||(c=='\n')||(c=='\r');
+}
+
+static inline int is_delim(int c)
+{
+  return is_space(c)||(c=='[')||(c==']');
+}
+
+
+// Function to find the first character in [p,end) that is not white space.
+// Returns end if there is none.
+
+static inline const char *scan_space(const char *p, const char *end)
+{
+#if defined(BYTESCAN_AVX2)
+  const __m256i sp = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i nl = _mm256_set1_epi8('\n');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  while (end-p>=32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) p);
+    __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v,sp),_mm256_cmpeq_epi8(v,tab)),
+                                _mm256_or_si256(_mm256_cmpeq_epi8(v,nl),_mm256_cmpeq_epi8(v,cr)));
+    unsigned int mask = ~(unsigned int) _mm256_movemask_epi8(m);
+    if (mask!=0) return p + __builtin_ctz(mask);
+    p += 32;
+  }
+#elif defined(BYTESCAN_SSE2)
+  const __m128i sp = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i nl = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  while (end-p>=16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) p);
+    __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v,sp),_mm_cmpeq_epi8(v,tab)),
+                             _mm_or_si128(_mm_cmpeq_epi8(v,nl),_mm_cmpeq_epi8(v,cr)));
+    unsigned int mask = (~(unsigned int) _mm_movemask_epi8(m)) & 0xffff;
+    if (mask!=0) return p + __builtin_ctz(mask);
+    p += 16;
+  }
+#endif
+  while ((p<end)&&is_space((unsigned char) *p)) p++;
+  return p;
+}
+
+
+// Function to find the first white space or bracket character in [p,end),
+// i.e. the end of a key or a bare value.  Returns end if there is none.
+
+static inline const char *scan_delim(const char *p, const char *end)
+{
+#if defined(BYTESCAN_AVX2)
+  const __m256i sp = _mm256_set1_epi8(' ');
+  const __m256i tab = _mm256_set1_epi8('\t');
+  const __m256i nl = _mm256_set1_epi8('\n');
+  const __m256i cr = _mm256_set1_epi8('\r');
+  const __m256i open = _mm256_set1_epi8('[');
+  const __m256i close = _mm256_set1_epi8(']');
+  while (end-p>=32) {
+    __m256i v = _mm256_loadu_si256((const __m256i*) p);
+    __m256i m = _mm256_or_si256(_mm256_or_si256(_mm256_cmpeq_epi8(v,sp),_mm256_cmpeq_epi8(v,tab)),
+                                _mm256_or_si256(_mm256_cmpeq_epi8(v,nl),_mm256_cmpeq_epi8(v,cr)));
+    m = _mm256_or_si256(m,_mm256_or_si256(_mm256_cmpeq_epi8(v,open),_mm256_cmpeq_epi8(v,close)));
+    unsigned int mask = (unsigned int) _mm256_movemask_epi8(m);
+    if (mask!=0) return p + __builtin_ctz(mask);
+    p += 32;
+  }
+#elif defined(BYTESCAN_SSE2)
+  const __m128i sp = _mm_set1_epi8(' ');
+  const __m128i tab = _mm_set1_epi8('\t');
+  const __m128i nl = _mm_set1_epi8('\n');
+  const __m128i cr = _mm_set1_epi8('\r');
+  const __m128i open = _mm_set1_epi8('[');
+  const __m128i close = _mm_set1_epi8(']');
+  while (end-p>=16) {
+    __m128i v = _mm_loadu_si128((const __m128i*) p);
+    __m128i m = _mm_or_si128(_mm_or_si128(_mm_cmpeq_epi8(v,sp),_mm_cmpeq_epi8(v,tab)),
+                             _mm_or_si128(_mm_cmpeq_epi8(v,nl),_mm_cmpeq_epi8(v,cr)));
+    m = _mm_or_si128(m,_mm_or_si128(_mm_cmpeq_epi8(v,open),_mm_cmpeq_epi8(v,close)));
+    unsigned int mask = (unsigned int) _mm_movemask_epi8(m);
+    if (mask!=0) return p + __builtin_ctz(mask);
+    p += 16;
+  }
+#endif
+  while ((p<end)&&!is_delim((unsigned char) *p)) p++;
+  return p;
+}
+
+
+// Function to find the first occurrence of character c in [p,end).
+// Returns end if there is none.  The C library memchr is already
+// vectorized on the platforms we care about.
+
+static inline const char *scan_char(const char *p, const char *end, int c)
+{
+  const char *q = (const char*) memchr(p,c,end-p);
+  return (q==NULL) ? end : q;
+}
+
+
+// Function to parse a decimal integer held in [p,end), with an optional
+// sign.  Parsing stops at the first character that is not a digit.
+// Returns 1 if there were no digits, otherwise 0 with the value in *value.
+
+static inline int parse_int(const char *p, const char *end, long *value)
+{
+  int negative=0;
+  unsigned long result=0;
+  const char *start;
+
+  if ((p<end)&&((*p=='-')||(*p=='+'))) negative = (*p++=='-');
+  start = p;
+  while ((p<end)&&(*p>='0')&&(*p<='9')) result = 10*result + (*p++ - '0');
+  if (p==start) return 1;
+
+  *value = negative ? -(long) result : (long) result;
+  return 0;
+}
+
+
+// Function to parse a real number held in [p,end).  Plain decimals with up
+// to 15 significant digits and no exponent are converted exactly in place;
+// anything else (exponents, long mantissas, inf, nan) is handed to strtod
+// through a small local copy, so the result always equals strtod's.
+// Returns 1 if the text is not a number, otherwise 0 with the value in
+// *value.
+
+static inline int parse_double(const char *p, const char *end, double *value)
+{
+  static const double power[16] = { 1e0, 1e1, 1e2, 1e3, 1e4, 1e5, 1e6, 1e7,
+                                    1e8, 1e9, 1e10, 1e11, 1e12, 1e13, 1e14, 1e15 };
+  int negative=0;
+  int digits=0,decimals=0;
+  unsigned long mantissa=0;
+  const char *q=p;
+  char copy[64];
+  char *stop;
+
+  // Fast path: [sign] digits [. digits]
+
+  if ((q<end)&&((*q=='-')||(*q=='+'))) negative = (*q++=='-');
+  while ((q<end)&&(*q>='0')&&(*q<='9')) {
+    mantissa = 10*mantissa + (*q++ - '0');
+    digits++;
+  }
+  if ((q<end)&&(*q=='.')) {
+    q++;
+    while ((q<end)&&(*q>='0')&&(*q<='9')) {
+      mantissa = 10*mantissa + (*q++ - '0');
+      digits++;
+      decimals++;
+    }
+  }
+  if ((digits>0)&&(digits<=15)&&((q==end)||is_delim((unsigned char) *q))) {
+    *value = (double) mantissa / power[decimals];
+    if (negative) *value = -*value;
+    return 0;
+  }
+
+  // Slow path
+
+  if ((size_t) (end-p)>=sizeof(copy)) end = p + sizeof(copy) - 1;
+  memcpy(copy,p,end-p);
+  copy[end-p] = '\0';
+  *value = strtod(copy,&stop);
+  return (stop==copy);
+}
+
+#endif
@@ -0,0 +1,386 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Connected components of a network.  See "components.h".
+
+#include <stdlib.h>
+#include <pthread.h>
+#include "components.h"
+#include "loader.h"
+
+// Types
+
+typedef struct {
+  const CSR *graph;
+  uint32_t *parent;        // Parent of each vertex in the union-find
+                           // forest; roots are their own parents
+  uint32_t first,last;     // Range of vertices this part handles
+} COMPONENT_PART;
+
+
+// Function to find the root of the tree of vertex u in the union-find
+// forest, halving the path on the way.  A parent always has a smaller
+// number than its child and only roots are ever linked, so the parents
+// written here are still ancestors whatever the other threads do.
+
+uint32_t find_root(uint32_t *parent, uint32_t u)
+{
+  uint32_t p,g;
+
+  while ((p=__atomic_load_n(&parent[u],__ATOMIC_RELAXED))!=u) {
+    g = __atomic_load_n(&parent[p],__ATOMIC_RELAXED);
+    if (g!=p) __atomic_store_n(&parent[u],g,__ATOMIC_RELAXED);
+    u = g;
+  }
+  return u;
+}
+
+
+// Function to join the trees of vertices u and v, by linking the root
+// with the larger number under the other.  If another thread links that
+// root first, the roots are looked up again.
+
+void unite(uint32_t *parent, uint32_t u, uint32_t v)
+{
+  uint32_t expected;
+
+  while (1) {
+    u = find_root(parent,u);
+    v = find_root(parent,v);
+    if (u==v) return;
+    if (u<v) {
+      expected = u;
+      u = v;
+      v = expected;
+    }
+    expected = u;
+    if (__atomic_compare_exchange_n(&parent[u],&expected,v,false,
+                                    __ATOMIC_RELAXED,__ATOMIC_RELAXED)) return;
+  }
+}
+
+
+// Function to join the endpoints of the edges out of a range of vertices
+
+template <class NEIGHBORS>
+void unite_range(COMPONENT_PART *part)
+{
+  uint32_t u,v;
+
+  for (u=part->first; u<part->last; u++) {
+    NEIGHBORS it(part->graph,u);
+    while (it.next(v)) unite(part->parent,u,v);
+  }
+}
+
+
+// Thread function to join the endpoints of the edges of a part
+
+void *unite_part(void *arg)
+{
+  COMPONENT_PART *part = (COMPONENT_PART*) arg;
+
+  if (part->graph->packed!=NULL) unite_range<PACKED_NEIGHBORS>(part);
+  else unite_range<PLAIN_NEIGHBORS>(part);
+  return NULL;
+}
+
+
+// Thread function to point every vertex of a part straight at its root
+
+void *root_part(void *arg)
+{
+  uint32_t u;
+  COMPONENT_PART *part = (COMPONENT_PART*) arg;
+
+  for (u=part->first; u<part->last; u++)
+    __atomic_store_n(&part->parent[u],find_root(part->parent,u),__ATOMIC_RELAXED);
+  return NULL;
+}
+
+
+// Function to run a thread function on every part, the first one on the
+// calling thread.  A part whose thread cannot be started is run on the
+// calling thread too.
+
+void run_component_parts(COMPONENT_PART *parts, pthread_t *threads, int nparts,
+                         void *(*function)(void*))
+{
+  int p;
+
+  for (p=1; p<nparts; p++) {
+    if (pthread_create(&threads[p],NULL,function,&parts[p])!=0) {
+      threads[p] = 0;
+      function(&parts[p]);
+    }
+  }
+  function(&parts[0]);
+  for (p=1; p<nparts; p++) {
+    if (threads[p]!=0) pthread_join(threads[p],NULL);
+  }
+}
+
+
+// Function to make the union-find forest of a graph, in which the root of
+// every vertex is the first vertex of its component
+
+int join_vertices(uint32_t *parent, const CSR *graph, int nthreads)
+{
+  int p,nparts;
+  uint32_t u,first;
+  uint32_t n = (uint32_t) graph->nvertices;
+  uint64_t total = graph->offsets[n];
+  COMPONENT_PART *parts;
+  pthread_t *threads;
+
+  nparts = thread_count(nthreads);
+  if ((uint32_t) nparts>n) nparts = (int) n;
+  if (nparts<1) nparts = 1;
+
+  parts = (COMPONENT_PART*) calloc(nparts,sizeof(COMPONENT_PART));
+  threads = (pthread_t*) calloc(nparts,sizeof(pthread_t));
+  if ((parts==NULL)||(threads==NULL)) {
+    free(parts);
+    free(threads);
+    return 1;
+  }
+
+  // Cut the vertices into ranges with about the same number of edges
+
+  u = 0;
+  for (p=0; p<nparts; p++) {
+    first = u;
+    while ((u<n)&&((p==nparts-1)||((uint64_t) graph->offsets[u]<total*(p+1)/nparts))) u++;
+    parts[p].graph = graph;
+    parts[p].parent = parent;
+    parts[p].first = first;
+    parts[p].last = u;
+  }
+
+  for (u=0; u<n; u++) parent[u] = u;
+  run_component_parts(parts,threads,nparts,unite_part);
+
+  // The vertices are then pointed at their roots with the same ranges,
+  // which are only a rough cut here
+
+  run_component_parts(parts,threads,nparts,root_part);
+
+  free(parts);
+  free(threads);
+  return 0;
+}
+
+
+// Function to find the components of a graph
+
+int find_components(COMPONENTS *components, const CSR *graph, int nthreads)
+{
+  uint32_t u,c,k;
+  uint32_t n = (uint32_t) graph->nvertices;
+  uint32_t *component;
+  uint64_t *entries;
+
+  components->nvertices = graph->nvertices;
+  components->ncomponents = 0;
+  components->size = NULL;
+  components->kind = NULL;
+  components->sources = NULL;
+  components->nsources = 0;
+  components->starts = NULL;
+  components->nstarts = 0;
+  components->component = component = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+  if (component==NULL) return 1;
+
+  if (join_vertices(component,graph,nthreads)) {
+    free_components(components);
+    return 1;
+  }
+
+  // Number the components in the order of their roots.  The root of a
+  // vertex comes before it, so its number is known by then.
+
+  for (u=0; u<n; u++) {
+    if (component[u]==u) component[u] = components->ncomponents++;
+    else component[u] = component[component[u]];
+  }
+
+  // Count the vertices and edge entries of each component, and tell the
+  // trivial ones
+
+  c = components->ncomponents;
+  components->size = (uint32_t*) calloc(c+1,sizeof(uint32_t));
+  components->kind = (unsigned char*) malloc(c+1);
+  entries = (uint64_t*) calloc(c+1,sizeof(uint64_t));
+  if ((components->size==NULL)||(components->kind==NULL)||(entries==NULL)) {
+    free(entries);
+    free_components(components);
+    return 1;
+  }
+
+  for (u=0; u<n; u++) {
+    components->size[component[u]]++;
+    entries[component[u]] += graph->offsets[u+1] - graph->offsets[u];
+  }
+
+  for (k=0; k<c; k++) {
+    if (components->size[k]==1) components->kind[k] = COMPONENT_ISOLATED;
+    else if (components->size[k]==2) components->kind[k] = COMPONENT_PAIR;
+    else if ((graph->directed==0)&&(entries[k]==2*((uint64_t) components->size[k]-1)))
+      components->kind[k] = COMPONENT_TREE;
+    else components->kind[k] = COMPONENT_GENERAL;
+  }
+  free(entries);
+
+  // Make the tables of sources and start vertices
+
+  for (u=0; u<n; u++) {
+    if (!trivial_vertex(components,u)) components->nsources++;
+    if (graph->offsets[u+1]>graph->offsets[u]) components->nstarts++;
+  }
+  components->sources = (uint32_t*) malloc((components->nsources+1)*sizeof(uint32_t));
+  components->starts = (uint32_t*) malloc((components->nstarts+1)*sizeof(uint32_t));
+  if ((components->sources==NULL)||(components->starts==NULL)) {
+    free_components(components);
+    return 1;
+  }
+
+  components->nsources = components->nstarts = 0;
+  for (u=0; u<n; u++) {
+    if (!trivial_vertex(components,u)) components->sources[components->nsources++] = u;
+    if (graph->offsets[u+1]>graph->offsets[u]) components->starts[components->nstarts++] = u;
+  }
+
+  return 0;
+}
+
+
+// Function to free the arrays of a COMPONENTS struct
+
+void free_components(COMPONENTS *components)
+{
+  free(components->component);
+  free(components->size);
+  free(components->kind);
+  free(components->sources);
+  free(components->starts);
+  components->component = NULL;
+  components->size = NULL;
+  components->kind = NULL;
+  components->sources = NULL;
+  components->starts = NULL;
+}
+
+
+// Function to work out the betweenness of the vertices of the tree that
+// vertex r is the first of.  The tree is searched breadth-first from r,
+// and the size of the subtree under every vertex found in the reverse
+// order of the search.  The sums of the squares of the branch sizes are
+// gathered in values[] first.
+
+template <class NEIGHBORS>
+void tree_values(double values[], const CSR *graph, uint32_t r, uint32_t size,
+                 uint32_t *order, uint32_t *parent, uint32_t *below)
+{
+  uint32_t head,tail,x,y;
+  double branches = size - 1.0,up;
+
+  order[0] = r;
+  parent[r] = r;
+  tail = 1;
+  for (head=0; head<tail; head++) {
+    x = order[head];
+    values[x] = 0.0;
+    below[x] = 1;
+    NEIGHBORS it(graph,x);
+    while (it.next(y)) {
+      if (y==parent[x]) continue;
+      parent[y] = x;
+      order[tail++] = y;
+    }
+  }
+
+  for (head=tail-1; head>0; head--) {
+    x = order[head];
+    values[parent[x]] += (double) below[x] * below[x];
+    below[parent[x]] += below[x];
+  }
+
+  for (head=0; head<tail; head++) {
+    x = order[head];
+    up = (double) size - below[x];
+    values[x] = branches*branches - values[x] - up*up;
+  }
+}
+
+
+// Function to store the betweenness of the vertices in trivial components
+
+int trivial_betweenness(double values[], const COMPONENTS *components, const CSR *graph)
+{
+  uint32_t u,next=0;
+  uint32_t n = (uint32_t) components->nvertices;
+  uint32_t *order=NULL,*parent=NULL,*below=NULL;
+  int kind;
+
+  for (u=0; u<n; u++) {
+    kind = components->kind[components->component[u]];
+    if ((kind==COMPONENT_ISOLATED)||(kind==COMPONENT_PAIR)) values[u] = 0.0;
+  }
+
+  for (u=0; u<n; u++) {
+
+    // Each tree is done from its first vertex, the first vertex met with
+    // the next component number
+
+    if (components->component[u]!=next) continue;
+    next++;
+    if (components->kind[components->component[u]]!=COMPONENT_TREE) continue;
+
+    if (order==NULL) {
+      order = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+      parent = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+      below = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+      if ((order==NULL)||(parent==NULL)||(below==NULL)) {
+        free(order);
+        free(parent);
+        free(below);
+        return 1;
+      }
+    }
+
+    if (graph->packed!=NULL)
+      tree_values<PACKED_NEIGHBORS>(values,graph,u,components->size[components->component[u]],
+                                    order,parent,below);
+    else
+      tree_values<PLAIN_NEIGHBORS>(values,graph,u,components->size[components->component[u]],
+                                   order,parent,below);
+  }
+
+  free(order);
+  free(parent);
+  free(below);
+  return 0;
+}
@@ -0,0 +1,105 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Connected components of a network, and the shortcuts they allow
+//
+// Many real networks hold a large number of vertices with no edges, of
+// pairs and of small trees next to one large component.  The algorithms
+// waste their time on these: the k-path walkers draw start vertices until
+// one has an edge, and the betweenness algorithms run a whole search from
+// every source in them.  find_components() labels the components once,
+// with a union-find over the edges on several threads, in which roots
+// are linked with compare-and-swap.  The components of a directed network
+// are its weakly connected components.  Each component is one of:
+//
+//   COMPONENT_ISOLATED   a single vertex, perhaps with self-loops
+//   COMPONENT_PAIR       two vertices
+//   COMPONENT_TREE       three or more vertices and no cycles, in an
+//                        undirected network
+//   COMPONENT_GENERAL    anything else
+//
+// The first three are trivial: their betweenness is known in closed form.
+// No vertex of an isolated vertex or a pair is ever between two others.
+// In a tree there is one path between any two vertices, whatever the
+// weights, so a vertex whose removal leaves branches of b1,...,bk
+// vertices lies on the paths of (b1+...+bk)^2 - (b1^2+...+bk^2) ordered
+// pairs, which is what the searches from every source add up to.
+// trivial_betweenness() fills these values in, and the algorithms only
+// search from the vertices in "sources", those of the other components.
+// The vertices in "starts" are those with at least one edge out, from
+// which a walk can start.
+//
+// Function calls:
+//   int find_components(COMPONENTS *components, const CSR *graph, int nthreads)
+//     -- Finds the components of "graph" using up to "nthreads" threads
+//        (0 means one per online processor).  Returns 0 if successful, 1
+//        if memory runs out.
+//   void free_components(COMPONENTS *components)
+//     -- Frees the arrays of a COMPONENTS struct again
+//   int trivial_vertex(const COMPONENTS *components, uint32_t v)
+//     -- Returns 1 if vertex v lies in a trivial component, otherwise 0
+//   int trivial_betweenness(double values[], const COMPONENTS *components,
+//                           const CSR *graph)
+//     -- Stores the betweenness of every vertex in a trivial component in
+//        values[], counting ordered pairs of sources and targets as the
+//        algorithms do.  The values of the other vertices are left as they
+//        are.  Returns 0 if successful, 1 if memory runs out.
+
+#ifndef COMPONENTS_H
+#define COMPONENTS_H
+
+#include "csr.h"
+
+// Kinds of component
+
+enum { COMPONENT_GENERAL, COMPONENT_ISOLATED, COMPONENT_PAIR, COMPONENT_TREE };
+
+typedef struct {
+  int nvertices;           // Number of vertices of the graph
+  uint32_t ncomponents;    // Number of components
+  uint32_t *component;     // Component of each vertex.  Components are
+                           // numbered in the order of their first vertex
+  uint32_t *size;          // Number of vertices of each component
+  unsigned char *kind;     // One of the COMPONENT_ constants for each
+                           // component
+  uint32_t *sources;       // Vertices of the components that are not
+                           // trivial, in increasing order
+  uint32_t nsources;       // Number of entries in sources[]
+  uint32_t *starts;        // Vertices with at least one edge out, in
+                           // increasing order
+  uint32_t nstarts;        // Number of entries in starts[]
+} COMPONENTS;
+
+int find_components(COMPONENTS *components, const CSR *graph, int nthreads);
+void free_components(COMPONENTS *components);
+int trivial_betweenness(double values[], const COMPONENTS *components, const CSR *graph);
+
+inline int trivial_vertex(const COMPONENTS *components, uint32_t v)
+{
+  return components->kind[components->component[v]]!=COMPONENT_GENERAL;
+}
+
+#endif
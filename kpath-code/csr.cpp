@@ -0,0 +1,523 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Compressed sparse row form of a network.  See "csr.h".
+
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include "csr.h"
+#include "loader.h"
+
+// Types
+
+typedef struct {
+  const CSR *graph;
+  CSR *reverse;
+  uint32_t first,last;     // Range of vertices whose out-edges this part
+                           // handles
+  uint32_t rfirst,rlast;   // Range of vertices whose in-edges it handles
+  uint32_t *cursor;        // Next free place in the in-edges of each vertex
+} REVERSE_PART;
+
+
+// Function to find the narrowest storage for the weights of a network.
+// Sets the weight type, the common weight and the largest weight of
+// "graph".
+
+void classify_weights(CSR *graph, NETWORK *network)
+{
+  int u,j;
+  int seen=0,uniform=1,whole=1,single=1;
+  double w,first=1.0,max=1.0;
+  EDGE *edge;
+
+  for (u=0; u<network->nvertices; u++) {
+    edge = network->vertex[u].edge;
+    for (j=0; j<network->vertex[u].degree; j++) {
+      w = edge[j].weight;
+      if (!seen) {
+        first = max = w;
+        seen = 1;
+      }
+      if (w!=first) uniform = 0;
+      if (w>max) max = w;
+      if (!(w>=1.0)||(w>UINT32_MAX)||(w!=(double) (uint32_t) w)) whole = 0;
+      if ((double) (float) w!=w) single = 0;
+    }
+  }
+
+  graph->weight = first;
+  graph->max_weight = max;
+  if (uniform&&(first==1.0)) graph->weighttype = WEIGHTS_NONE;
+  else if (uniform&&(first>0.0)) graph->weighttype = WEIGHTS_UNIFORM;
+  else if (whole&&(max<=255)) graph->weighttype = WEIGHTS_U8;
+  else if (whole&&(max<=65535)) graph->weighttype = WEIGHTS_U16;
+  else if (whole) graph->weighttype = WEIGHTS_U32;
+  else if (single) graph->weighttype = WEIGHTS_FLOAT;
+  else graph->weighttype = WEIGHTS_DOUBLE;
+}
+
+
+// Function to find the bytes taken by one weight of a given type
+
+size_t weight_width(int weighttype)
+{
+  switch (weighttype) {
+  case WEIGHTS_U8: return sizeof(uint8_t);
+  case WEIGHTS_U16: return sizeof(uint16_t);
+  case WEIGHTS_U32: return sizeof(uint32_t);
+  case WEIGHTS_FLOAT: return sizeof(float);
+  case WEIGHTS_DOUBLE: return sizeof(double);
+  default: return 0;
+  }
+}
+
+
+// Function to build the CSR form of a network
+
+int build_csr(CSR *graph, NETWORK *network)
+{
+  int u,j;
+  uint32_t k;
+  size_t total,width;
+  EDGE *edge;
+
+  graph->nvertices = network->nvertices;
+  graph->directed = network->directed;
+  graph->offsets = NULL;
+  graph->targets = NULL;
+  graph->weights = NULL;
+  graph->packed = NULL;
+  graph->packedoffsets = NULL;
+  graph->replicas = NULL;
+  graph->nreplicas = 0;
+  graph->mapping = NULL;
+  graph->mappinglength = 0;
+  graph->reverse = NULL;
+  graph->placement = 0;
+  graph->hugepages = 0;
+
+  total = 0;
+  for (u=0; u<network->nvertices; u++) total += network->vertex[u].degree;
+  if (total>UINT32_MAX) return 1;
+  graph->nedges = (int) total;
+
+  classify_weights(graph,network);
+  width = weight_width(graph->weighttype);
+
+  graph->offsets = (uint32_t*) malloc((network->nvertices+1)*sizeof(uint32_t));
+  graph->targets = (uint32_t*) malloc((total+1)*sizeof(uint32_t));
+  if (width>0) graph->weights = malloc((total+1)*width);
+  if ((graph->offsets==NULL)||(graph->targets==NULL)||((width>0)&&(graph->weights==NULL))) {
+    free_csr(graph);
+    return 1;
+  }
+
+  k = 0;
+  for (u=0; u<network->nvertices; u++) {
+    graph->offsets[u] = k;
+    edge = network->vertex[u].edge;
+    for (j=0; j<network->vertex[u].degree; j++,k++) {
+      graph->targets[k] = (uint32_t) edge[j].target;
+      switch (graph->weighttype) {
+      case WEIGHTS_U8: ((uint8_t*) graph->weights)[k] = (uint8_t) edge[j].weight; break;
+      case WEIGHTS_U16: ((uint16_t*) graph->weights)[k] = (uint16_t) edge[j].weight; break;
+      case WEIGHTS_U32: ((uint32_t*) graph->weights)[k] = (uint32_t) edge[j].weight; break;
+      case WEIGHTS_FLOAT: ((float*) graph->weights)[k] = (float) edge[j].weight; break;
+      case WEIGHTS_DOUBLE: ((double*) graph->weights)[k] = edge[j].weight; break;
+      }
+    }
+  }
+  graph->offsets[network->nvertices] = k;
+
+  return 0;
+}
+
+
+// Function to free the arrays of a CSR graph.  The copies of the graph
+// point at the copies of its reverse, which are freed with the reverse.
+// A replicated graph shares the arrays of its copy on node 0, which are
+// freed with the copy.
+
+void free_csr(CSR *graph)
+{
+  int k;
+  int shared = (graph->replicas!=NULL);
+
+  for (k=0; k<graph->nreplicas; k++) {
+    graph->replicas[k].reverse = NULL;
+    free_csr(&graph->replicas[k]);
+  }
+  free(graph->replicas);
+  graph->replicas = NULL;
+  graph->nreplicas = 0;
+  if (graph->reverse!=NULL) {
+    free_csr(graph->reverse);
+    free(graph->reverse);
+    graph->reverse = NULL;
+  }
+  if (graph->mapping!=NULL) {
+    if (graph->mappinglength>0) munmap(graph->mapping,graph->mappinglength);
+  } else if (!shared) {
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->weights);
+    free(graph->packed);
+    free(graph->packedoffsets);
+  }
+  graph->mapping = NULL;
+  graph->offsets = NULL;
+  graph->targets = NULL;
+  graph->weights = NULL;
+  graph->packed = NULL;
+  graph->packedoffsets = NULL;
+}
+
+
+// Function to compare two neighbors
+
+int cmptarget(const void *a, const void *b)
+{
+  uint32_t x = *(const uint32_t*) a;
+  uint32_t y = *(const uint32_t*) b;
+
+  return (x>y) - (x<y);
+}
+
+
+// Function to write a varint at "out", or only count its bytes if "out"
+// is NULL.  Returns the number of bytes.
+
+size_t put_varint(unsigned char *out, uint32_t x)
+{
+  size_t n=1;
+
+  for (; x>=0x80; x>>=7,n++) {
+    if (out!=NULL) *out++ = (unsigned char) (x | 0x80);
+  }
+  if (out!=NULL) *out = (unsigned char) x;
+  return n;
+}
+
+
+// Function to write the packed list of vertex u at "out", or only count
+// its bytes if "out" is NULL.  The plain list must be sorted.  Returns the
+// number of bytes.
+
+size_t pack_list(const CSR *graph, uint32_t u, unsigned char *out)
+{
+  uint32_t j;
+  int32_t d;
+  size_t n=0;
+
+  // The first difference is taken modulo 2^32, which is how it is added
+  // back when the list is read
+
+  for (j=graph->offsets[u]; j<graph->offsets[u+1]; j++) {
+    if (j==graph->offsets[u]) {
+      d = (int32_t) (graph->targets[j] - u);
+      n += put_varint(out==NULL ? NULL : out+n,((uint32_t) d<<1) ^ (uint32_t) (d>>31));
+    } else n += put_varint(out==NULL ? NULL : out+n,graph->targets[j]-graph->targets[j-1]);
+  }
+
+  return n;
+}
+
+
+// Function to sort the neighbor lists of a graph and pack them into new
+// arrays.  Returns 0 if successful, 1 if memory runs out.
+
+int pack_lists(CSR *graph, unsigned char **packed, uint64_t **packedoffsets)
+{
+  uint32_t u;
+  uint32_t n = (uint32_t) graph->nvertices;
+  uint64_t length;
+
+  *packedoffsets = (uint64_t*) malloc((n+1)*sizeof(uint64_t));
+  if (*packedoffsets==NULL) return 1;
+
+  // Sort the lists and work out where each packed list starts
+
+  (*packedoffsets)[0] = 0;
+  for (u=0, length=0; u<n; u++) {
+    qsort(graph->targets+graph->offsets[u],graph->offsets[u+1]-graph->offsets[u],
+          sizeof(uint32_t),cmptarget);
+    length += pack_list(graph,u,NULL);
+    (*packedoffsets)[u+1] = length;
+  }
+
+  *packed = (unsigned char*) malloc((*packedoffsets)[n]+1);
+  if (*packed==NULL) {
+    free(*packedoffsets);
+    return 1;
+  }
+  for (u=0; u<n; u++) pack_list(graph,u,*packed+(*packedoffsets)[u]);
+
+  return 0;
+}
+
+
+// Function to pack the neighbor lists of an unweighted graph and of its
+// reverse.  Both are packed before either one's plain lists are freed.
+
+int compress_csr(CSR *graph)
+{
+  CSR *reverse = graph->reverse;
+  unsigned char *packed,*rpacked=NULL;
+  uint64_t *packedoffsets,*rpackedoffsets=NULL;
+
+  if ((graph->weights!=NULL)||(graph->packed!=NULL)) return 1;
+  if (pack_lists(graph,&packed,&packedoffsets)) return 1;
+  if ((reverse!=NULL)&&pack_lists(reverse,&rpacked,&rpackedoffsets)) {
+    free(packed);
+    free(packedoffsets);
+    return 1;
+  }
+
+  free(graph->targets);
+  graph->targets = NULL;
+  graph->packed = packed;
+  graph->packedoffsets = packedoffsets;
+  if (reverse!=NULL) {
+    free(reverse->targets);
+    reverse->targets = NULL;
+    reverse->packed = rpacked;
+    reverse->packedoffsets = rpackedoffsets;
+  }
+  return 0;
+}
+
+
+// Function to find the vertex an edge leaves from, given its place in
+// targets[]
+
+uint32_t edge_source(const CSR *graph, uint32_t j)
+{
+  uint32_t low=0,high=(uint32_t) graph->nvertices,mid;
+
+  // The source is the last vertex whose edges start at or before j
+
+  while (high-low>1) {
+    mid = low + (high-low)/2;
+    if (graph->offsets[mid]<=j) low = mid;
+    else high = mid;
+  }
+  return low;
+}
+
+
+// Thread function to count the in-edges of every vertex, from the
+// out-edges of a range of vertices.  The counts go one place up in the
+// offsets of the reverse, ready to be summed.
+
+void *count_part(void *arg)
+{
+  uint32_t u,j;
+  REVERSE_PART *part = (REVERSE_PART*) arg;
+  const CSR *graph = part->graph;
+
+  for (u=part->first; u<part->last; u++) {
+    for (j=graph->offsets[u]; j<graph->offsets[u+1]; j++)
+      __atomic_fetch_add(&part->reverse->offsets[graph->targets[j]+1],1,__ATOMIC_RELAXED);
+  }
+  return NULL;
+}
+
+
+// Thread function to file the out-edges of a range of vertices among the
+// in-edges of their targets.  What is filed is the place of the edge in
+// targets[], as the places in each list are taken in no fixed order.
+
+void *scatter_part(void *arg)
+{
+  uint32_t u,j,k;
+  REVERSE_PART *part = (REVERSE_PART*) arg;
+  const CSR *graph = part->graph;
+
+  for (u=part->first; u<part->last; u++) {
+    for (j=graph->offsets[u]; j<graph->offsets[u+1]; j++) {
+      k = __atomic_fetch_add(&part->cursor[graph->targets[j]],1,__ATOMIC_RELAXED);
+      part->reverse->targets[k] = j;
+    }
+  }
+  return NULL;
+}
+
+
+// Thread function to put the in-edges of a range of vertices in the order
+// of the edges, and replace each filed edge by its source and weight
+
+void *finish_part(void *arg)
+{
+  uint32_t v,k,j;
+  REVERSE_PART *part = (REVERSE_PART*) arg;
+  const CSR *graph = part->graph;
+  CSR *reverse = part->reverse;
+  size_t width = weight_width(graph->weighttype);
+
+  for (v=part->rfirst; v<part->rlast; v++) {
+    qsort(reverse->targets+reverse->offsets[v],reverse->offsets[v+1]-reverse->offsets[v],
+          sizeof(uint32_t),cmptarget);
+    for (k=reverse->offsets[v]; k<reverse->offsets[v+1]; k++) {
+      j = reverse->targets[k];
+      if (width>0) memcpy((char*) reverse->weights + k*width,(const char*) graph->weights + j*width,width);
+      reverse->targets[k] = edge_source(graph,j);
+    }
+  }
+  return NULL;
+}
+
+
+// Function to run a thread function on every part, the first one on the
+// calling thread.  A part whose thread cannot be started is run on the
+// calling thread too.
+
+void run_parts(REVERSE_PART *parts, pthread_t *threads, int nparts, void *(*function)(void*))
+{
+  int p;
+
+  for (p=1; p<nparts; p++) {
+    if (pthread_create(&threads[p],NULL,function,&parts[p])!=0) {
+      threads[p] = 0;
+      function(&parts[p]);
+    }
+  }
+  function(&parts[0]);
+  for (p=1; p<nparts; p++) {
+    if (threads[p]!=0) pthread_join(threads[p],NULL);
+  }
+}
+
+
+// Function to cut the vertices into one range for each part, with about
+// the same number of edges in each, given the offsets of their edges.
+// The ranges are those of the out-edges of the parts, or with "in" set
+// those of their in-edges.
+
+void cut_ranges(const uint32_t offsets[], uint32_t n, REVERSE_PART parts[], int nparts, int in)
+{
+  int p;
+  uint32_t u=0,first;
+  uint64_t total = offsets[n];
+
+  for (p=0; p<nparts; p++) {
+    first = u;
+    while ((u<n)&&((p==nparts-1)||((uint64_t) offsets[u]<total*(p+1)/nparts))) u++;
+    if (in) {
+      parts[p].rfirst = first;
+      parts[p].rlast = u;
+    } else {
+      parts[p].first = first;
+      parts[p].last = u;
+    }
+  }
+}
+
+
+// Function to build the in-edges of a graph
+
+int reverse_csr(CSR *graph, int nthreads)
+{
+  int p,nparts;
+  uint32_t u;
+  uint32_t n = (uint32_t) graph->nvertices;
+  size_t width = weight_width(graph->weighttype);
+  uint32_t *cursor;
+  CSR *reverse;
+  REVERSE_PART *parts;
+  pthread_t *threads;
+
+  if ((graph->targets==NULL)||(graph->reverse!=NULL)) return 1;
+
+  nparts = thread_count(nthreads);
+  if ((uint32_t) nparts>n) nparts = (int) n;
+  if (nparts<1) nparts = 1;
+
+  reverse = (CSR*) malloc(sizeof(CSR));
+  parts = (REVERSE_PART*) calloc(nparts,sizeof(REVERSE_PART));
+  threads = (pthread_t*) calloc(nparts,sizeof(pthread_t));
+  cursor = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+  if ((reverse==NULL)||(parts==NULL)||(threads==NULL)||(cursor==NULL)) {
+    free(reverse);
+    free(parts);
+    free(threads);
+    free(cursor);
+    return 1;
+  }
+
+  *reverse = *graph;
+  reverse->replicas = NULL;
+  reverse->nreplicas = 0;
+  reverse->mapping = NULL;
+  reverse->mappinglength = 0;
+  reverse->weights = NULL;
+  reverse->offsets = (uint32_t*) calloc(n+1,sizeof(uint32_t));
+  reverse->targets = (uint32_t*) malloc(((size_t) graph->nedges+1)*sizeof(uint32_t));
+  if (width>0) reverse->weights = malloc(((size_t) graph->nedges+1)*width);
+  if ((reverse->offsets==NULL)||(reverse->targets==NULL)||((width>0)&&(reverse->weights==NULL))) {
+    free_csr(reverse);
+    free(reverse);
+    free(parts);
+    free(threads);
+    free(cursor);
+    return 1;
+  }
+
+  for (p=0; p<nparts; p++) {
+    parts[p].graph = graph;
+    parts[p].reverse = reverse;
+    parts[p].cursor = cursor;
+  }
+  cut_ranges(graph->offsets,n,parts,nparts,0);
+
+  // Count the in-edges of each vertex and sum the counts into offsets
+
+  run_parts(parts,threads,nparts,count_part);
+  for (u=0; u<n; u++) reverse->offsets[u+1] += reverse->offsets[u];
+  memcpy(cursor,reverse->offsets,(n+1)*sizeof(uint32_t));
+
+  // File the edges, then sort out each list on the part that holds it
+
+  run_parts(parts,threads,nparts,scatter_part);
+  cut_ranges(reverse->offsets,n,parts,nparts,1);
+  run_parts(parts,threads,nparts,finish_part);
+
+  graph->reverse = reverse;
+  free(parts);
+  free(threads);
+  free(cursor);
+  return 0;
+}
+
+
+// Function to find the graph of the in-edges
+
+CSR *in_edges(CSR *graph)
+{
+  return (graph->reverse!=NULL) ? graph->reverse : graph;
+}
@@ -0,0 +1,212 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Compressed sparse row form of a network for the algorithms
+//
+// A NETWORK keeps, for every vertex, a VERTEX struct with a pointer to its
+// EDGE structs, and each EDGE holds a weight next to its target: 16 bytes
+// per edge, most of them not needed when the network is unweighted.  The
+// algorithms read a CSR graph instead, in which the edges of vertex u are
+// targets[offsets[u]] to targets[offsets[u+1]-1], with their weights at
+// the same positions of a separate weights array that is only there when
+// the network is weighted.  A breadth-first search then reads 4 bytes per
+// edge it follows.
+//
+// The weights are stored as narrow as they allow:
+//
+//   WEIGHTS_NONE      every weight is 1; no array
+//   WEIGHTS_UNIFORM   every weight is the same positive number, kept in
+//                     "weight"; no array.  Shortest paths are the same as
+//                     with no weights
+//   WEIGHTS_U8        whole numbers from 1 to 255, as uint8_t
+//   WEIGHTS_U16       whole numbers from 1 to 65535, as uint16_t
+//   WEIGHTS_U32       whole numbers from 1 to 2^32-1, as uint32_t
+//   WEIGHTS_FLOAT     numbers that a float holds exactly, as float
+//   WEIGHTS_DOUBLE    anything else, as double
+//
+// so that the algorithms can pick the fastest search that gives the same
+// results: breadth-first search for the first two, a bucket queue for
+// small whole numbers and a heap otherwise.
+//
+// The neighbor lists of an unweighted graph can also be packed, for
+// networks too large to hold as plain lists.  Each list is sorted and
+// stored as the differences between successive neighbors, each one a
+// varint: 7 bits to a byte, with the top bit set on every byte but the
+// last.  The first neighbor is stored as its difference from the vertex
+// itself, mapped to an unsigned number by zigzag encoding.  On networks
+// whose neighbors have close numbers, which reordering helps with (see
+// "reorder.h"), most differences fit in one byte.  The lists are decoded
+// as they are read, through the NEIGHBORS iterators below, which the
+// breadth-first kernels are written against.
+//
+// A directed graph can also carry its in-edges, as a second CSR graph in
+// "reverse" whose targets are the sources of the edges into each vertex,
+// with their weights.  The betweenness algorithms look the predecessors of
+// a vertex up there instead of recording them during every search, and
+// can search level by level from the unreached vertices backwards.  An
+// undirected graph is its own reverse.
+//
+// Function calls:
+//   int build_csr(CSR *graph, NETWORK *network)
+//     -- Builds the CSR form of "network", keeping the order of the edges
+//        of every vertex, and classifies its weights.  Returns 0 if
+//        successful, 1 if memory runs out or the network is too large for
+//        32-bit indices.
+//   void free_csr(CSR *graph)
+//     -- Frees the arrays of a CSR graph, and of its copies, again, or
+//        unmaps them if the graph was attached to a shared segment
+//   size_t weight_width(int weighttype)
+//     -- Returns the bytes taken by one weight of the given WEIGHTS_ type,
+//        0 if there is no weights array
+//   int compress_csr(CSR *graph)
+//     -- Packs the neighbor lists of an unweighted graph, and those of its
+//        reverse, and frees the plain ones.  Returns 0 if successful, 1 if
+//        the graph has a weights array or memory runs out; the plain
+//        lists are then kept, though they may have been sorted.
+//   int reverse_csr(CSR *graph, int nthreads)
+//     -- Builds the in-edges of "graph", which must not be compressed yet,
+//        using up to "nthreads" threads (0 means one per online
+//        processor).  The sources of the edges into each vertex are in
+//        the order of the edges in "graph".  Returns 0 if successful, 1 if
+//        memory runs out.
+//   CSR *in_edges(CSR *graph)
+//     -- Returns the graph of the in-edges: the reverse of a directed
+//        graph, or the graph itself if it is undirected
+
+#ifndef CSR_H
+#define CSR_H
+
+#include <stddef.h>
+#include <stdint.h>
+#include "network.h"
+
+// How the edge weights are stored
+
+enum { WEIGHTS_NONE, WEIGHTS_UNIFORM, WEIGHTS_U8, WEIGHTS_U16, WEIGHTS_U32,
+       WEIGHTS_FLOAT, WEIGHTS_DOUBLE };
+
+typedef struct CSR {
+  int nvertices;       // Number of vertices
+  int nedges;          // Number of entries in targets[], i.e. edges of a
+                       // directed network and twice the edges otherwise
+  int directed;        // 1 = directed network, 0 = undirected
+  uint32_t *offsets;   // Start of the edges of each vertex in targets[],
+                       // nvertices+1 entries
+  uint32_t *targets;   // Index of the vertex at the end of each edge
+  int weighttype;      // One of the WEIGHTS_ constants
+  double weight;       // Weight of every edge for WEIGHTS_NONE and
+                       // WEIGHTS_UNIFORM
+  double max_weight;   // Largest weight
+  void *weights;       // Weight of each edge, of the type given by
+                       // weighttype.  NULL for WEIGHTS_NONE and
+                       // WEIGHTS_UNIFORM
+  unsigned char *packed;     // Packed neighbor lists, NULL unless the
+                             // graph is compressed, when targets is NULL
+  uint64_t *packedoffsets;   // Start of the list of each vertex in
+                             // packed[], nvertices+1 entries
+  struct CSR *replicas;      // Copy of the graph on each memory node if
+                             // it is replicated (see "placement.h"),
+                             // otherwise NULL.  The arrays above are
+                             // then those of the copy on node 0
+  int nreplicas;             // Number of copies in replicas[]
+  void *mapping;             // Shared segment the arrays lie in if the
+                             // graph was attached (see "sharedgraph.h"),
+                             // otherwise NULL
+  size_t mappinglength;      // Length of the mapping, 0 if the arrays
+                             // lie in the mapping of another graph
+  struct CSR *reverse;       // In-edges of a directed graph, NULL until
+                             // they are built
+  int placement;             // PLACE_ policy the arrays were placed by
+                             // (see "placement.h"), 0 (PLACE_LOCAL)
+                             // until they are
+  int hugepages;             // 1 if the arrays were put on huge pages
+} CSR;
+
+int build_csr(CSR *graph, NETWORK *network);
+void free_csr(CSR *graph);
+size_t weight_width(int weighttype);
+int compress_csr(CSR *graph);
+int reverse_csr(CSR *graph, int nthreads);
+CSR *in_edges(CSR *graph);
+
+// Iterators over the neighbors of vertex u, for plain and packed lists.
+// Both are used as
+//
+//   NEIGHBORS it(graph,u);
+//   while (it.next(v)) ...
+
+struct PLAIN_NEIGHBORS {
+  const uint32_t *p;
+  const uint32_t *end;
+
+  PLAIN_NEIGHBORS(const CSR *graph, uint32_t u)
+    : p(graph->targets+graph->offsets[u]), end(graph->targets+graph->offsets[u+1]) {}
+
+  bool next(uint32_t &v)
+  {
+    if (p==end) return false;
+    v = *p++;
+    return true;
+  }
+};
+
+struct PACKED_NEIGHBORS {
+  const unsigned char *p;
+  uint32_t left;       // Neighbors still to be read
+  uint32_t last;       // Last neighbor read, or u before the first
+  bool first;
+
+  PACKED_NEIGHBORS(const CSR *graph, uint32_t u)
+    : p(graph->packed+graph->packedoffsets[u]), left(graph->offsets[u+1]-graph->offsets[u]),
+      last(u), first(true) {}
+
+  bool next(uint32_t &v)
+  {
+    uint32_t x,b;
+    int shift;
+
+    if (left==0) return false;
+    left--;
+    x = *p++;
+    if (x&0x80) {
+      x &= 0x7f;
+      shift = 7;
+      do {
+        b = *p++;
+        x |= (b & 0x7f) << shift;
+        shift += 7;
+      } while (b&0x80);
+    }
+    if (first) {
+      last += (x>>1) ^ (0u-(x&1));
+      first = false;
+    } else last += x;
+    v = last;
+    return true;
+  }
+};
+
+#endif
@@ -0,0 +1,89 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Reading of gzip- and zstd-compressed input
+//
+// A compressed file is decompressed on a producer thread, which feeds the
+// text into a bounded ring buffer while the parser takes it out at the
+// other end, so decompression runs at the same time as parsing.  Support
+// for each format is compiled in when HAVE_ZLIB or HAVE_ZSTD is defined;
+// the Makefile does this when the library is installed.
+//
+// Function calls:
+//   int stream_compression(FILE *stream)
+//     -- Returns the COMPRESSION_ type of the stream, from the magic number
+//        at its current position.  Regular files are checked with pread(),
+//        other streams by looking at their next character.  The stream
+//        position is not changed.
+//   int open_decoder(DECODER *decoder, FILE *stream, int type)
+//     -- Starts decompressing "stream".  Returns 0 if successful, 1 if the
+//        format is not supported by this build or memory ran out.
+//   size_t decoder_read(DECODER *decoder, char *buffer, size_t length)
+//     -- Copies up to "length" decompressed characters into "buffer",
+//        waiting for the producer if there are none yet.  Returns the
+//        number copied, which is 0 only at the end of the text.  If the
+//        input is corrupt the text ends early and decoder->error is set.
+//   void close_decoder(DECODER *decoder)
+//     -- Stops the producer thread and frees the ring buffer
+//   size_t peek_decompressed(FILE *stream, int type, char *buffer, size_t length)
+//     -- Decompresses the start of a compressed regular file into "buffer"
+//        without changing the stream position, for guessing the format of
+//        its text.  Returns the number of characters obtained.
+
+#ifndef DECODER_H
+#define DECODER_H
+
+#include <stdio.h>
+#include <pthread.h>
+
+#define RINGLENGTH (1<<22)       // Decompressed text held between the threads
+#define DECODEBLOCK (1<<18)      // Compressed or decompressed text handled
+                                 // at once by the producer
+
+enum { COMPRESSION_NONE, COMPRESSION_GZIP, COMPRESSION_ZSTD };
+
+typedef struct {
+  FILE *stream;        // Compressed input
+  int type;            // COMPRESSION_ type of the input
+  char *ring;          // Ring buffer of RINGLENGTH characters
+  size_t written;      // Characters put into the ring so far
+  size_t read;         // Characters taken out of the ring so far
+  int done;            // 1 once the producer has put in all it will
+  int stop;            // 1 if the consumer has gone away
+  int error;           // 1 if the input could not be decompressed
+  pthread_t thread;    // Producer thread
+  pthread_mutex_t lock;
+  pthread_cond_t changed;  // Signalled whenever written, read, done or
+                           // stop changes
+} DECODER;
+
+int stream_compression(FILE *stream);
+int open_decoder(DECODER *decoder, FILE *stream, int type);
+size_t decoder_read(DECODER *decoder, char *buffer, size_t length);
+void close_decoder(DECODER *decoder);
+size_t peek_decompressed(FILE *stream, int type, char *buffer, size_t length);
+
+#endif
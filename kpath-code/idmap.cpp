@@ -0,0 +1,101 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Mapping of vertex IDs to vertex indices.  See "idmap.h".
+
+#include <stdlib.h>
+#include <string.h>
+#include "idmap.h"
+
+
+// Function to build the map
+
+int build_idmap(IDMAP *map, const VERTEX vertex[], int nvertices)
+{
+  int i;
+  int64_t min,max;
+  uint64_t slot;
+
+  memset(map,0,sizeof(IDMAP));
+
+  min = max = 0;
+  for (i=0; i<nvertices; i++) {
+    if ((i==0)||(vertex[i].id<min)) min = vertex[i].id;
+    if ((i==0)||(vertex[i].id>max)) max = vertex[i].id;
+  }
+
+  // Direct table.  Vertices are entered from the last to the first, so
+  // that the first of any repeated IDs wins.
+
+  if ((uint64_t) max - (uint64_t) min < IDMAP_DENSITY*(uint64_t) nvertices + 64) {
+    map->dense = 1;
+    map->min = min;
+    map->size = (uint64_t) max - (uint64_t) min + 1;
+    map->index = (int*) malloc(map->size*sizeof(int));
+    if (map->index==NULL) return 1;
+    memset(map->index,-1,map->size*sizeof(int));
+    for (i=nvertices-1; i>=0; i--) map->index[vertex[i].id-min] = i;
+    return 0;
+  }
+
+  // Hash table
+
+  map->size = 2;
+  map->shift = 63;
+  while (map->size<2*(uint64_t) nvertices) {
+    map->size *= 2;
+    map->shift--;
+  }
+  map->index = (int*) malloc(map->size*sizeof(int));
+  map->key = (int64_t*) malloc(map->size*sizeof(int64_t));
+  if ((map->index==NULL)||(map->key==NULL)) {
+    free_idmap(map);
+    return 1;
+  }
+  memset(map->index,-1,map->size*sizeof(int));
+
+  for (i=0; i<nvertices; i++) {
+    slot = idmap_hash(map,vertex[i].id);
+    while ((map->index[slot]>=0)&&(map->key[slot]!=vertex[i].id))
+      slot = (slot+1) & (map->size-1);
+    if (map->index[slot]<0) {
+      map->index[slot] = i;
+      map->key[slot] = vertex[i].id;
+    }
+  }
+
+  return 0;
+}
+
+
+// Function to free the map again
+
+void free_idmap(IDMAP *map)
+{
+  free(map->index);
+  free(map->key);
+  memset(map,0,sizeof(IDMAP));
+}
@@ -0,0 +1,98 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Mapping of vertex IDs to indices in the vertex[] array
+//
+// The readers use this to turn the IDs of edge endpoints into vertex
+// indices.  When the IDs are compact (at most IDMAP_DENSITY times as many
+// possible values between the smallest and largest ID as there are
+// vertices, as for IDs numbered from 0 or 1) the index is looked up
+// directly in a table.  Otherwise the IDs are kept in an open-addressing
+// hash table with linear probing, sized to be at most half full.  Either
+// way a lookup costs a few memory accesses, whatever the size of the
+// network.
+//
+// Function calls:
+//   int build_idmap(IDMAP *map, const VERTEX vertex[], int nvertices)
+//     -- Builds the map for the IDs of the given vertices.  If an ID is
+//        repeated, the first vertex with it is found.  Returns 0 if
+//        successful, 1 if memory could not be allocated.
+//   int idmap_find(const IDMAP *map, int64_t id)
+//     -- Returns the index of the vertex with the given ID, or -1 if there
+//        is none
+//   void free_idmap(IDMAP *map)
+//     -- Frees the memory of the map again
+
+#ifndef IDMAP_H
+#define IDMAP_H
+
+#include <stdint.h>
+#include "network.h"
+
+#define IDMAP_DENSITY 4
+
+typedef struct {
+  int dense;           // 1 for a direct table, 0 for a hash table
+  int64_t min;         // Smallest ID (direct table)
+  uint64_t size;       // Number of slots: ID range of a direct table, or
+                       // a power of two for a hash table
+  int shift;           // 64 - log2(size), for the hash function
+  int *index;          // Vertex index held in each slot, -1 if empty
+  int64_t *key;        // ID held in each slot of a hash table
+} IDMAP;
+
+int build_idmap(IDMAP *map, const VERTEX vertex[], int nvertices);
+void free_idmap(IDMAP *map);
+
+
+// Function to find the slot where an ID belongs in a hash table.  The
+// multiplier is 2^64 divided by the golden ratio, which spreads runs of
+// consecutive IDs evenly over the table.
+
+static inline uint64_t idmap_hash(const IDMAP *map, int64_t id)
+{
+  return ((uint64_t) id*0x9E3779B97F4A7C15ULL) >> map->shift;
+}
+
+
+static inline int idmap_find(const IDMAP *map, int64_t id)
+{
+  uint64_t slot;
+
+  if (map->dense) {
+    slot = (uint64_t) id - (uint64_t) map->min;
+    return (slot<map->size) ? map->index[slot] : -1;
+  }
+
+  slot = idmap_hash(map,id);
+  while (map->index[slot]>=0) {
+    if (map->key[slot]==id) return map->index[slot];
+    slot = (slot+1) & (map->size-1);
+  }
+  return -1;
+}
+
+#endif
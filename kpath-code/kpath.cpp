@@ -27,261 +27,542 @@ THE SOFTWARE.
 #include "kpath.h"
 
 /* 
- * K-Path Centrality for weighted graphs
+ * The share of the k-path walks that one thread takes. Every walk draws from its own stream of 
+ * random numbers and every thread counts its visits apart; the counts are summed up at the end 
  */ 
-void kpathcentrality_Weighted( f64 NOV[ ], NETWORK *network, f64 alpha, ui64 plength, f64 &time_dif ) {
+typedef struct {
+	CSR *graph;							// The graph; the thread reads the copy of it on its own node
+	const COMPONENTS *components;		// The vertices the walks start from
+	ui64 plength;						// Longest walk
+	ui64 firstwalk, lastwalk;			// Range of the walks the thread takes
+	ui64 seed;							// Seed of the random numbers
+	int index;							// Number of the thread, from 0
+	int pin;							// Pin the thread to a CPU
+	f64 *NOV;							// The visits the thread counted
+	f64 **counts;						// The visits counted by every thread, to sum up
+	void **prefix;						// Running sums of the inverse weights of the edges of each vertex, on weighted graphs: one 
+										// copy for each copy of the graph, or a single one
+	int nprefix;						// Number of copies of the running sums
+	int nworkers;						// Number of threads
+	ui64 first, last;					// Range of vertices whose visits the thread sums up, and whose sums of inverse weights it builds
+	int failed;							// Set if the thread ran out of memory
+} KPATH_WORKER;
+
+/* 
+ * The vertices one walk has explored. A walk takes at most plength steps, so they are kept in a small 
+ * array instead of being marked in an array over all the vertices, and it fits in the first-level 
+ * cache. Short walks search it from the end; longer ones also keep the vertices in a small 
+ * open-addressing table 
+ */ 
+struct KPATH_VISITED {
+	vector<uint32_t> vertex;			// The vertices in the order the walk reached them
+	vector<uint32_t> table;				// The vertices plus one, by hash with linear probing; 0 is a free slot. Empty for short walks
+	int shift;							// 64 less the bits of the size of the table
 	
-	ui64 i, j, k, x, nloops;
-	ui64 nvertices, degree, randL, *Explored;
-	f64 randWeight, Weight, TotInvWeight;
-	stack <ui64> S;  
-	time_t start, end;
+	void reserve ( ui64 plength ) {
+		ui64 size = 1;
+		
+		shift = 64;
+		vertex.reserve ( plength + 1 );
+		if ( plength + 1 > KPATH_SCAN ) {
+			while ( size < 4 * ( plength + 1 ) ) {
+				size *= 2;
+				shift--;
+			}
+			table.assign ( size, 0 );
+		}
+	}
 	
-	//Start time before k-path Centrality Algorithm
-	time ( &start );
+	void clear ( ) {
+		vertex.clear ( );
+		if ( !table.empty ( ) )
+			fill ( table.begin ( ), table.end ( ), 0 );
+	}
 	
-	//Get user inputs and calculate number of loops
-	nvertices = (ui64) network->nvertices;
-	nloops = (ui64) (2 * plength * plength * pow((f64)nvertices,(1 -(2*alpha))) * log((f64)nvertices) ) + 1;
+	void add ( uint32_t v ) {
+		ui64 k;
+		
+		vertex.push_back ( v );
+		if ( !table.empty ( ) ) {
+			for ( k = ( (ui64) v * 0x9E3779B97F4A7C15ull ) >> shift; table[ k ] != 0; k = ( k + 1 ) & ( table.size ( ) - 1 ) ) ;
+			table[ k ] = v + 1;
+		}
+	}
 	
-	//Allocate memory
-	Explored = ( ui64* ) calloc ( nvertices, sizeof ( ui64 ) );
-	if ( Explored == NULL ) {
-		cout << "Allocating memory for Explored list failed." << endl;
-		return;
+	bool has ( uint32_t v ) const {
+		ui64 k;
+		
+		if ( table.empty ( ) ) {
+			for ( k = vertex.size ( ); k > 0; k-- )
+				if ( vertex[ k - 1 ] == v )
+					return true;
+			return false;
+		}
+		for ( k = ( (ui64) v * 0x9E3779B97F4A7C15ull ) >> shift; table[ k ] != 0; k = ( k + 1 ) & ( table.size ( ) - 1 ) )
+			if ( table[ k ] == v + 1 )
+				return true;
+		return false;
 	}
+};
+
+/* 
+ * Whether the neighbors of a vertex can be read at any position, which drawing them by rejection needs. 
+ * Packed lists can only be decoded in order 
+ */ 
+template <class NEIGHBORS> 
+struct KPATH_DIRECT { static const bool value = false; };
+
+template <> 
+struct KPATH_DIRECT <PLAIN_NEIGHBORS> { static const bool value = true; };
+
+/* 
+ * Build the running sums of the inverse weights of the edges of a range of the vertices, with the 
+ * weights stored as W, in every copy of the sums. The sum up to the last edge of a vertex is the total 
+ * of its inverse weights; an edge of weight 0 adds nothing, so that it is never picked 
+ */ 
+template <class W> 
+void *kpathcentrality_Prefix( void *arg ) {
 	
-	// Set all vertices to be unexplored and set NOV to zero 
-	for ( j = 0; j < nvertices; j++ ) { 
-		Explored[ j ] = 0;
-		NOV[j] = 0; 
+	KPATH_WORKER *worker = ( KPATH_WORKER * ) arg;
+	const CSR *graph = worker->graph;
+	const W *weights = ( const W * ) graph->weights;
+	f64 *prefix = ( f64* ) worker->prefix[ 0 ];
+	f64 Weight, TotInvWeight;
+	ui64 i, k, start, end;
+	int c;
+	
+	start = (ui64) graph->offsets[ worker->first ];
+	end = (ui64) graph->offsets[ worker->last ];
+	for ( i = worker->first; i < worker->last; i++ ) {
+		TotInvWeight = 0;
+		for ( k = (ui64) graph->offsets[ i ]; k < (ui64) graph->offsets[ i + 1 ]; k++ ) {
+			Weight = (f64) weights[ k ];
+			if ( Weight != 0 )
+				TotInvWeight += ( 1 / Weight );
+			prefix[ k ] = TotInvWeight;
+		}
 	}
+	for ( c = 1; c < worker->nprefix; c++ ) 
+		memcpy ( ( f64* ) worker->prefix[ c ] + start, prefix + start, ( end - start ) * sizeof ( f64 ) );
+	return NULL;
+}
+
+/* 
+ * The k-path walks of one thread on a weighted graph, with the weights stored as W, drawing the edges 
+ * of hubs from the running sums of their inverse weights
+ */ 
+template <class W> 
+void *kpathcentrality_Weighted( void *arg ) {
 	
-	//Generate a random seed using time
-	srand ( time ( NULL ) );
+	KPATH_WORKER *worker = ( KPATH_WORKER * ) arg;
+	const COMPONENTS *components = worker->components;
+	const f64 *prefix;
+	ui64 i, j, k, x, count;
+	ui64 nvertices, nstarts, first, degree, randL, plength;
+	KPATH_VISITED Visited;				// The vertices the current walk has explored
+	f64 *NOV;
+	f64 randWeight, Weight, TotInvWeight;
+	CSR *graph;
+	const W *weights;
+	
+	// Keep the thread on its own CPU if asked to, and read the copies of the graph and of the sums on its node
+	if ( worker->pin )
+		pin_thread ( worker->index );
+	graph = local_csr ( worker->graph );
+	weights = ( const W * ) graph->weights;
+	prefix = ( const f64* ) worker->prefix[ ( worker->nprefix > 1 ) ? graph - worker->graph->replicas : 0 ];
+	
+	nvertices = (ui64) graph->nvertices;
+	nstarts = (ui64) components->nstarts;
+	plength = worker->plength;
+	
+	//Allocate memory, from the thread itself and placed as the graph is. The first thread counts the visits into the result
+	Visited.reserve ( plength );
+	if ( worker->NOV == NULL )
+		worker->NOV = ( f64* ) place_state ( worker->graph, nvertices * sizeof ( f64 ) );
+	NOV = worker->NOV;
+	if ( NOV == NULL ) {
+		worker->failed = 1;
+		return NULL;
+	}
+	
+	// Set NOV to zero 
+	for ( j = 0; j < nvertices; j++ ) 
+		NOV[j] = 0; 
 	
 	// k-path Centrality Algorithm for weighted graphs
-	for ( i = 0; i < nloops; i++ ) {
+	for ( i = worker->firstwalk; ( nstarts > 0 ) && ( i < worker->lastwalk ); i++ ) {
 		
-		//pick a random vertex as the source vertex
-		x = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*nvertices);
+		// The random numbers of walk i, the same whichever thread takes it
+		RNG random ( worker->seed, RNG_STREAM ( RNG_KPATH, i ) );
 		
-		// Get the degree of the randomly chosen vertex x
-		degree = (ui64) network->vertex[ x ].degree;
+		// Pick a random source vertex among those with an edge to follow
+		x = (ui64) components->starts[ random.below ( nstarts ) ];
 		
-		// As long as the degress is zero, keep randomly choosing the vertex x
-		while( degree == 0 ) {
-			x = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*nvertices);
-			degree = (ui64) network->vertex[ x ].degree;
-		}
+		// Get the degree of the randomly chosen vertex x
+		first = (ui64) graph->offsets[ x ];
+		degree = (ui64) graph->offsets[ x + 1 ] - first;
 		
-		Explored[ x ] = 1;
-		S.push(x); 
+		Visited.clear ( );
+		Visited.add ( (uint32_t) x );
 		
 		// Pick a random length less or equal to path length
-		randL = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*plength) + 1;
+		randL = random.below ( plength ) + 1;
 
 		// Inner loop less or equal to path length
 		for ( j = 0; j < randL; j++ ) {
-			TotInvWeight = 0;
 			
-			// Add all edge weights that lead to unexplored vertices
-			for ( k = 0; k < degree; k++ ) {
-				if ( Explored[ network->vertex[ x ].edge[ k ].target ] == 0 ) {
-					Weight = network->vertex[ x ].edge[ k ].weight;
-					if ( Weight != 0 )
-						TotInvWeight += ( 1 / Weight );
+			// On a vertex of many neighbors, draw an edge by binary search in the running sums of the 
+			// inverse weights until it leads to an unexplored vertex. Each accepted draw picks an unexplored 
+			// edge with probability inversely proportional to its weight, as the scan below does. Add the 
+			// weights up below if too many draws fail 
+			count = KPATH_REJECT_TRIES;
+			if ( ( degree >= KPATH_REJECT_DEGREE ) && ( prefix[ first + degree - 1 ] > 0 ) ) {
+				for ( count = 0; count < KPATH_REJECT_TRIES; count++ ) {
+					randWeight = random.unit ( ) * prefix[ first + degree - 1 ];
+					k = (ui64) ( upper_bound ( prefix + first, prefix + first + degree, randWeight ) - ( prefix + first ) );
+					if ( ( k < degree ) && !Visited.has ( graph->targets[ first + k ] ) )
+						break;
 				}
 			}
-
-			// If all edges lead to explored vertices break from the inner loop
-			if ( TotInvWeight == 0 )
-				break;
 			
-			/* 
-			 * Randomly pick an edge out of the remaining unexplored edges with probability 
-			 * inversely proportional to its edge weight
-			 */
-			randWeight = (((f64) rand())/((f64) RAND_MAX + 1.0))*TotInvWeight;
-			TotInvWeight = 0;
-			for ( k = 0; k < degree; k++ ) {
-				if ( Explored[ network->vertex[ x ].edge[ k ].target ] == 0 ) {
-					Weight = network->vertex[ x ].edge[ k ].weight;
-					if ( Weight != 0 ) {
-						TotInvWeight += ( 1 / Weight );
-						if ( TotInvWeight > randWeight )
-							break;
+			if ( count == KPATH_REJECT_TRIES ) {
+				TotInvWeight = 0;
+				
+				// Add all edge weights that lead to unexplored vertices
+				for ( k = 0; k < degree; k++ ) {
+					if ( !Visited.has ( graph->targets[ first + k ] ) ) {
+						Weight = (f64) weights[ first + k ];
+						if ( Weight != 0 )
+							TotInvWeight += ( 1 / Weight );
+					}
+				}
+				
+				// If all edges lead to explored vertices break from the inner loop
+				if ( TotInvWeight == 0 )
+					break;
+				
+				/* 
+				 * Randomly pick an edge out of the remaining unexplored edges with probability 
+				 * inversely proportional to its edge weight
+				 */
+				randWeight = random.unit ( ) * TotInvWeight;
+				TotInvWeight = 0;
+				for ( k = 0; k < degree; k++ ) {
+					if ( !Visited.has ( graph->targets[ first + k ] ) ) {
+						Weight = (f64) weights[ first + k ];
+						if ( Weight != 0 ) {
+							TotInvWeight += ( 1 / Weight );
+							if ( TotInvWeight > randWeight )
+								break;
+						}
 					}
 				}
 			}
-
+			
 			// Set the target vertex as the new source vertex
-			x = network->vertex[ x ].edge[ k ].target;
+			x = graph->targets[ first + k ];
 			
 			// Set the degree to the new vertex degree
-			degree = (ui64) network->vertex[ x ].degree;
+			first = (ui64) graph->offsets[ x ];
+			degree = (ui64) graph->offsets[ x + 1 ] - first;
 			 
 			//mark the new vertex as explored and increase the number of visites
-			Explored[ x ] = 1;
+			Visited.add ( (uint32_t) x );
 			NOV[ x ] += 1;
-			S.push(x); 
 			
 		} // End For loop for path length
 		
-		while(!S.empty()) {
-			x = S.top(); 
-			Explored[x] = 0; 
-			S.pop();
-
-			/* if message traversal stops in less than l edges, reset count values to the old ones */
-			if(j < randL )
-				NOV[ x ] -= 1;
-		}
+		/* if message traversal stops in less than l edges, reset count values to the old ones */
+		if ( j < randL )
+			for ( x = 0; x < Visited.vertex.size ( ); x++ )
+				NOV[ Visited.vertex[ x ] ] -= 1;
 		
 	} // End For loop for number of iterations
 	
-	//End time after k-path Centrality Algorithm and Time difference
-	time ( &end );
-	time_dif = difftime ( end, start );
-	cout << "It took " << time_dif << " seconds to calculate k-path Centrality on a weighted graph" << endl;
-	
-	//Approximate value
-	for ( i = 0; i < nvertices; i++ ) 
-		NOV[ i ] = (NOV[ i ] * plength * nvertices ) / nloops;		
-	
-	//Dealocate memory
-	free ( Explored );
-	return; 
+	return NULL; 
 	
 } // End Program
 
 /* 
- * K-Path Centrality for unweighted graphs
+ * The k-path walks of one thread on an unweighted graph
  */ 
-void kpathcentrality_Unweighted( f64 NOV[ ], NETWORK *network, f64 alpha, ui64 plength, f64 &time_dif ) {
+template <class NEIGHBORS> 
+void *kpathcentrality_Unweighted( void *arg ) {
 	
-	ui64 i, j, k, x, count, randCount, nloops;
-	ui64 nvertices, degree, randL, *Explored;
-	stack <ui64> S;  
-	time_t start, end;
+	KPATH_WORKER *worker = ( KPATH_WORKER * ) arg;
+	const COMPONENTS *components = worker->components;
+	ui64 i, j, x, count, randCount;
+	ui64 nvertices, nstarts, first, degree, randL, plength;
+	KPATH_VISITED Visited;				// The vertices the current walk has explored
+	f64 *NOV;
+	uint32_t v;
+	CSR *graph;
 	
-	//Start time before k-path Centrality Algorithm
-	time ( &start );
+	// Keep the thread on its own CPU if asked to, and read the copy of the graph on its node
+	if ( worker->pin )
+		pin_thread ( worker->index );
+	graph = local_csr ( worker->graph );
 	
-	//Get user inputs and calculate number of loops
-	nvertices = (ui64) network->nvertices;
-	nloops = (ui64) (2 * plength * plength * pow((f64)nvertices,(1 -(2*alpha))) * log((f64)nvertices) ) + 1;
-	 
-	//Allocate memory
-	Explored = ( ui64* ) calloc ( nvertices, sizeof ( ui64 ) );
-	if ( Explored == NULL ) {
-		cout << "Allocating memory for Explored list failed." << endl;
-		return;
+	nvertices = (ui64) graph->nvertices;
+	nstarts = (ui64) components->nstarts;
+	plength = worker->plength;
+	
+	//Allocate memory, from the thread itself and placed as the graph is. The first thread counts the visits into the result
+	Visited.reserve ( plength );
+	if ( worker->NOV == NULL )
+		worker->NOV = ( f64* ) place_state ( worker->graph, nvertices * sizeof ( f64 ) );
+	NOV = worker->NOV;
+	if ( NOV == NULL ) {
+		worker->failed = 1;
+		return NULL;
 	}
-
-	// Set all vertices to be unexplored and set NOV to zero 
-	for ( j = 0; j < nvertices; j++ ) { 
-		Explored[ j ] = 0;
+	
+	// Set NOV to zero 
+	for ( j = 0; j < nvertices; j++ ) 
 		NOV[j] = 0; 
-	}
 	
-	//Generate a random seed using time
-	srand ( time ( NULL ) );
-
 	/* k-path Centrality Algorithm for unweighted graphs */ 
-	for ( i = 0; i < nloops; i++ ) {
+	for ( i = worker->firstwalk; ( nstarts > 0 ) && ( i < worker->lastwalk ); i++ ) {
+		
+		// The random numbers of walk i, the same whichever thread takes it
+		RNG random ( worker->seed, RNG_STREAM ( RNG_KPATH, i ) );
 	
-		//pick a random vertex as the source vertex
-		x = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*nvertices);
+		// Pick a random source vertex among those with an edge to follow
+		x = (ui64) components->starts[ random.below ( nstarts ) ];
 		
 		// Get the degree of the randomly chosen vertex x
-		degree = (ui64) network->vertex[ x ].degree;
-			
-		// As long as the degress is zero, keep randomly choosing the vertex x
-		while( degree == 0 ) {
-			x = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*nvertices);
-			degree = (ui64) network->vertex[ x ].degree;
-		}
+		first = (ui64) graph->offsets[ x ];
+		degree = (ui64) graph->offsets[ x + 1 ] - first;
 		
-		Explored[ x ] = 1;
-		S.push(x); 
+		Visited.clear ( );
+		Visited.add ( (uint32_t) x );
 		
 		// Pick a random length less or equal to path length
-		randL = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*plength) + 1;
+		randL = random.below ( plength ) + 1;
 
 		// Inner loop less or equal to path length
 		for ( j = 0; j < randL; j++ ) {
-			count = 0;
-			
-			// Add all edge weights that lead to unexplored vertices
-			for ( k = 0; k < degree; k++ )
-				if ( Explored[ network->vertex[ x ].edge[ k ].target ] == 0 )
-					count++;
 			
-			// If all edges lead to explored vertices break from the inner loop
-			if ( count == 0 )
-				break;
-			
-			// Randomly pick an edge out of the remaining unexplored edges
-			randCount = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*count);
-			count = 0;
-			for ( k = 0; k < degree; k++ ) {
-				if ( Explored[ network->vertex[ x ].edge[ k ].target ] == 0 ) {
-					count++;
-					if ( count > randCount )
+			// On a vertex of many neighbors, draw one at random until it is unexplored. A walk has explored 
+			// at most plength vertices, so this rarely takes more than one draw, and each accepted draw is 
+			// equally likely to be any unexplored edge. Count the neighbors below if too many draws fail 
+			count = KPATH_REJECT_TRIES;
+			if ( KPATH_DIRECT<NEIGHBORS>::value && ( degree >= KPATH_REJECT_DEGREE ) ) {
+				for ( count = 0; count < KPATH_REJECT_TRIES; count++ ) {
+					v = graph->targets[ first + random.below ( degree ) ];
+					if ( !Visited.has ( v ) ) 
 						break;
 				}
 			}
 			
+			if ( count == KPATH_REJECT_TRIES ) {
+				count = 0;
+				
+				// Add all edge weights that lead to unexplored vertices
+				NEIGHBORS all ( graph, (uint32_t) x );
+				while ( all.next ( v ) )
+					if ( !Visited.has ( v ) )
+						count++;
+				
+				// If all edges lead to explored vertices break from the inner loop
+				if ( count == 0 )
+					break;
+				
+				// Randomly pick an edge out of the remaining unexplored edges
+				randCount = random.below ( count );
+				count = 0;
+				NEIGHBORS pick ( graph, (uint32_t) x );
+				while ( pick.next ( v ) ) {
+					if ( !Visited.has ( v ) ) {
+						count++;
+						if ( count > randCount )
+							break;
+					}
+				}
+			}
+			
 			// Set the target vertex as the new source vertex
-			x = network->vertex[ x ].edge[ k ].target;
+			x = (ui64) v;
 					
 			// Set the degree to the new vertex degree
-			degree = (ui64) network->vertex[ x ].degree;
+			first = (ui64) graph->offsets[ x ];
+			degree = (ui64) graph->offsets[ x + 1 ] - first;
 			
 			//mark the new vertex as explored and increase the number of visites
-			Explored[ x ] = 1;
+			Visited.add ( (uint32_t) x );
 			NOV[ x ] += 1;
-			S.push(x); 
 			
 		} // End For loop for path length
 		
-		while(!S.empty()) {
-			x = S.top(); 
-			Explored[x] = 0; 
-			S.pop(); 
-
-			/* if message traversal stops in less than l edges, reset count values to the old ones */
-			if(j < randL )
-				NOV[ x ] -= 1;
-		}		
+		/* if message traversal stops in less than l edges, reset count values to the old ones */
+		if ( j < randL )
+			for ( x = 0; x < Visited.vertex.size ( ); x++ )
+				NOV[ Visited.vertex[ x ] ] -= 1;
 		
 	} // End For loop for number of iterations
 
-	//End time after k-path Centrality Algorithm and Time difference
-	time ( &end );
-	time_dif = difftime ( end, start );
-	cout << "It took " << time_dif << " seconds to calculate k-path Centrality on a unweighted graph" << endl;
+	return NULL; 
+	
+} // End Program
 
-	//Approximate value
-	for ( i = 0; i < nvertices; i++ ) 
-		 NOV[ i ] = (NOV[ i ] * plength * nvertices ) / nloops;
 
-	//Dealocate memory
-	free ( Explored );
+/* 
+ * Sum the visits counted by every thread into those of the first one, for a range of the vertices
+ */ 
+void *kpathcentrality_Sum( void *arg ) {
 	
-	return; 
-
-} // End Program
+	KPATH_WORKER *worker = ( KPATH_WORKER * ) arg;
+	f64 *NOV = worker->counts[ 0 ];
+	ui64 i;
+	int t;
+	
+	for ( t = 1; t < worker->nworkers; t++ )
+		for ( i = worker->first; i < worker->last; i++ )
+			NOV[ i ] += worker->counts[ t ][ i ];
+	return NULL;
+}
 
+/* 
+ * Run a thread function for every worker, the first one on the calling thread. A worker whose 
+ * thread cannot be started is run on the calling thread too
+ */ 
+void kpathcentrality_Run( vector<KPATH_WORKER> &workers, void *( *function )( void * ) ) {
+	
+	int t, nworkers = (int) workers.size();
+	vector<pthread_t> threads ( nworkers, 0 );
+	
+	for ( t = 1; t < nworkers; t++ ) {
+		if ( pthread_create ( &threads[ t ], NULL, function, &workers[ t ] ) != 0 ) {
+			threads[ t ] = 0;
+			function ( &workers[ t ] );
+		}
+	}
+	function ( &workers[ 0 ] );
+	for ( t = 1; t < nworkers; t++ )
+		if ( threads[ t ] != 0 )
+			pthread_join ( threads[ t ], NULL );
+	return;
+}
 
 /* 
- * K-Path Centrality - Choose between weighted or unweighted graphs
+ * K-Path Centrality - Share the walks among the threads, with the walker for the way the weights are stored
  */ 
-void kpathcentrality( f64 NOV[ ], NETWORK *network, f64 alpha, ui64 plength, f64 &time_dif ) {
-	if ( ( network->MAX_Weight != 1 ) || ( network->MIN_Weight != 1 ) )
-		kpathcentrality_Weighted ( NOV, network, alpha, plength, time_dif );
-	else
-		kpathcentrality_Unweighted ( NOV, network, alpha, plength, time_dif );
+void kpathcentrality( f64 NOV[ ], CSR *graph, const COMPONENTS *components, f64 alpha, ui64 plength, int nthreads, int pin, ui64 seed, f64 &time_dif ) {
+	
+	ui64 i, nvertices, nloops;
+	int t, nworkers, failed = 0;
+	void *( *walker )( void * );
+	void *( *builder )( void * ) = NULL;
+	vector<KPATH_WORKER> workers;
+	vector<f64 *> counts;
+	vector<void *> prefix;
+	time_t start, end;
+	
+	//Start time before k-path Centrality Algorithm
+	time ( &start );
+	
+	//Get user inputs and calculate number of loops
+	nvertices = (ui64) graph->nvertices;
+	nloops = (ui64) (2 * plength * plength * pow((f64)nvertices,(1 -(2*alpha))) * log((f64)nvertices) ) + 1;
+	
+	switch ( graph->weighttype ) {
+	case WEIGHTS_U8:
+		builder = kpathcentrality_Prefix<uint8_t>;
+		walker = kpathcentrality_Weighted<uint8_t>;
+		break;
+	case WEIGHTS_U16:
+		builder = kpathcentrality_Prefix<uint16_t>;
+		walker = kpathcentrality_Weighted<uint16_t>;
+		break;
+	case WEIGHTS_U32:
+		builder = kpathcentrality_Prefix<uint32_t>;
+		walker = kpathcentrality_Weighted<uint32_t>;
+		break;
+	case WEIGHTS_FLOAT:
+		builder = kpathcentrality_Prefix<float>;
+		walker = kpathcentrality_Weighted<float>;
+		break;
+	case WEIGHTS_DOUBLE:
+		builder = kpathcentrality_Prefix<double>;
+		walker = kpathcentrality_Weighted<double>;
+		break;
+	default:
+		// No weights, or the same weight on every edge: every unexplored edge is equally likely
+		if ( graph->packed != NULL )
+			walker = kpathcentrality_Unweighted<PACKED_NEIGHBORS>;
+		else
+			walker = kpathcentrality_Unweighted<PLAIN_NEIGHBORS>;
+	}
+	
+	// The running sums of the inverse weights, 8 bytes per edge, placed as the edges of the graph are: 
+	// a copy on every node if the graph is replicated, one shared by all the threads otherwise 
+	if ( builder != NULL ) {
+		prefix.resize ( ( graph->replicas != NULL ) ? graph->nreplicas : 1 );
+		if ( place_edges ( graph, sizeof ( f64 ), &prefix[ 0 ] ) != 0 ) {
+			cout << "Allocating memory for the inverse weight tables failed." << endl;
+			return;
+		}
+	}
+	
+	// One worker for each thread, with an equal share of the walks 
+	nworkers = thread_count ( nthreads );
+	if ( (ui64) nworkers > nloops )
+		nworkers = (int) nloops;
+	workers.resize ( nworkers );
+	counts.resize ( nworkers );
+	
+	for ( t = 0; t < nworkers; t++ ) {
+		workers[ t ].graph = graph;
+		workers[ t ].components = components;
+		workers[ t ].plength = plength;
+		workers[ t ].firstwalk = nloops * t / nworkers;
+		workers[ t ].lastwalk = nloops * ( t + 1 ) / nworkers;
+		workers[ t ].seed = seed;
+		workers[ t ].index = t;
+		workers[ t ].pin = pin;
+		workers[ t ].NOV = ( t == 0 ) ? NOV : NULL;
+		workers[ t ].counts = &counts[ 0 ];
+		workers[ t ].prefix = prefix.empty ( ) ? NULL : &prefix[ 0 ];
+		workers[ t ].nprefix = (int) prefix.size ( );
+		workers[ t ].nworkers = nworkers;
+		workers[ t ].first = nvertices * t / nworkers;
+		workers[ t ].last = nvertices * ( t + 1 ) / nworkers;
+		workers[ t ].failed = 0;
+	}
+	
+	// Build the inverse weight tables, each thread those of its range of the vertices
+	if ( builder != NULL ) {
+		kpathcentrality_Run ( workers, builder );
+		cout << "Built the inverse weight tables of " << ( ( (f64) prefix.size ( ) * graph->nedges * sizeof ( f64 ) ) / ( 1024 * 1024 ) ) << " MB (" << prefix.size ( ) << " cop" << ( prefix.size ( ) == 1 ? "y" : "ies" ) << ") with " << nworkers << " thread(s)" << endl;
+	}
+	
+	// Take the walks, then sum the visits of all threads up 
+	kpathcentrality_Run ( workers, walker );
+	for ( t = 0; t < nworkers; t++ ) {
+		counts[ t ] = workers[ t ].NOV;
+		failed |= workers[ t ].failed;
+	}
+	if ( failed ) 
+		cout << "Allocating memory for the visit counts failed." << endl;
+	else 
+		kpathcentrality_Run ( workers, kpathcentrality_Sum );
+	for ( t = 1; t < nworkers; t++ )
+		free ( counts[ t ] );
+	for ( t = 0; t < (int) prefix.size ( ); t++ )
+		free ( prefix[ t ] );
+	if ( failed ) 
+		return;
+	
+	//End time after k-path Centrality Algorithm and Time difference
+	time ( &end );
+	time_dif = difftime ( end, start );
+	cout << "It took " << time_dif << " seconds to calculate k-path Centrality on " << ( graph->weights != NULL ? "a weighted" : "a unweighted" ) << " graph with " << nworkers << " thread(s)" << endl;
+	
+	//Approximate value
+	for ( i = 0; i < nvertices; i++ ) 
+		NOV[ i ] = (NOV[ i ] * plength * nvertices ) / nloops;
+	
 	return; 
 }
+
@@ -35,13 +35,26 @@ typedef int i32;
 
 #include <iostream> 
 #include <stack>
+#include <algorithm>
+#include <vector>
 #include <math.h>
 #include <time.h>
 #include <limits.h>
-#include "network.h"
+#include <stdlib.h>
+#include <string.h>
+#include <pthread.h>
+#include "csr.h"
+#include "components.h"
+#include "rng.h"
+#include "placement.h"
+#include "loader.h"
 
 using namespace std;
 
-void kpathcentrality ( f64 NOV [ ], NETWORK *network, f64 alpha, ui64 plength, f64 &time_dif );
+#define KPATH_SCAN 32			// Most vertices of a walk that are searched one by one, without a hash table
+#define KPATH_REJECT_DEGREE 64	// Fewest neighbors for which a walk draws its next vertex by rejection instead of counting them
+#define KPATH_REJECT_TRIES 8	// Draws that may all land on explored vertices before the walk counts the neighbors after all
+
+void kpathcentrality ( f64 NOV [ ], CSR *graph, const COMPONENTS *components, f64 alpha, ui64 plength, int nthreads, int pin, ui64 seed, f64 &time_dif );
 
 #endif
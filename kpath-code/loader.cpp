@@ -0,0 +1,788 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Functions shared by the text readers.  See "loader.h".
+
+#include <pthread.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "loader.h"
+#include "bytescan.h"
+
+
+// Function to set up a reader on a stream.  Regular files are mapped into
+// memory from the current stream position; anything else gets a block
+// buffer, which compressed files fill through a decoder.  Returns 1 if
+// memory could not be allocated or the compression is not supported,
+// otherwise 0.
+
+int open_reader(READER *reader, FILE *stream)
+{
+  int compression;
+  long offset;
+  struct stat info;
+
+  memset(reader,0,sizeof(READER));
+
+  compression = stream_compression(stream);
+  offset = ftell(stream);
+  if ((compression==COMPRESSION_NONE)&&(offset>=0)&&(fstat(fileno(stream),&info)==0)
+      &&S_ISREG(info.st_mode)&&(info.st_size>offset)) {
+    reader->maplength = info.st_size;
+    reader->map = mmap(NULL,reader->maplength,PROT_READ,MAP_PRIVATE,fileno(stream),0);
+    if (reader->map!=MAP_FAILED) {
+      madvise(reader->map,reader->maplength,MADV_SEQUENTIAL);
+      reader->text = (const char*) reader->map + offset;
+      reader->len = reader->maplength - offset;
+      return 0;
+    }
+    reader->map = NULL;
+  }
+
+  reader->buffer = (char*) malloc(BUFFERLENGTH);
+  if (reader->buffer==NULL) return 1;
+  reader->stream = stream;
+  reader->text = reader->buffer;
+
+  if (compression!=COMPRESSION_NONE) {
+    reader->decoder = (DECODER*) malloc(sizeof(DECODER));
+    if ((reader->decoder==NULL)||open_decoder(reader->decoder,stream,compression)) {
+      free(reader->decoder);
+      free(reader->buffer);
+      return 1;
+    }
+  }
+
+  return 0;
+}
+
+
+// Function to release the mapping or buffer of a reader again
+
+void close_reader(READER *reader)
+{
+  if (reader->map!=NULL) munmap(reader->map,reader->maplength);
+  if (reader->decoder!=NULL) close_decoder(reader->decoder);
+  free(reader->decoder);
+  free(reader->buffer);
+}
+
+
+// Function to read more text into the block buffer.  The unread part of
+// the buffer is moved to its start first, so a token that was cut off at
+// the end of the buffer is completed in place.  Returns the number of new
+// characters, which is 0 at the end of the stream or for mapped files.
+
+size_t refill(READER *reader)
+{
+  size_t n;
+
+  if (reader->stream==NULL) return 0;
+  n = reader->len - reader->pos;
+  memmove(reader->buffer,reader->buffer+reader->pos,n);
+  reader->pos = 0;
+  reader->len = n;
+  if (reader->decoder!=NULL) n = decoder_read(reader->decoder,reader->buffer+n,BUFFERLENGTH-n);
+  else n = fread(reader->buffer+n,1,BUFFERLENGTH-n,reader->stream);
+  reader->len += n;
+
+  return n;
+}
+
+
+// Function to skip past the next occurrence of character c, refilling the
+// buffer as needed.  Used for comments and quoted strings.
+
+void skip_past(READER *reader, int c)
+{
+  const char *p;
+
+  while (1) {
+    p = scan_char(reader->text+reader->pos,reader->text+reader->len,c);
+    reader->pos = p - reader->text;
+    if (reader->pos<reader->len) {
+      reader->pos++;
+      return;
+    }
+    if (refill(reader)==0) return;
+  }
+}
+
+
+// Function to make space for one more node record and store it.  Returns
+// 1 if memory could not be allocated, otherwise 0.
+
+int add_vertex(RECORDS *records, int64_t id)
+{
+  int64_t *p;
+  long *l;
+
+  if (records->nvertices==records->maxvertices) {
+    records->maxvertices = 2*records->maxvertices + 1024;
+    p = (int64_t*) realloc(records->id,records->maxvertices*sizeof(int64_t));
+    if (p==NULL) return 1;
+    records->id = p;
+    if (records->label!=NULL) {
+      l = (long*) realloc(records->label,records->maxvertices*sizeof(long));
+      if (l==NULL) return 1;
+      records->label = l;
+    }
+  }
+  if (records->label!=NULL) records->label[records->nvertices] = -1;
+  records->id[records->nvertices++] = id;
+
+  return 0;
+}
+
+
+// Function to give the last node record a label.  The label array is only
+// created once the first label is met.  Returns 1 if memory could not be
+// allocated, otherwise 0.
+
+int add_label(RECORDS *records, const char *text, size_t length)
+{
+  int i;
+  char *t;
+
+  if (records->nvertices==0) return 0;
+  if (records->label==NULL) {
+    records->label = (long*) malloc(records->maxvertices*sizeof(long));
+    if (records->label==NULL) return 1;
+    for (i=0; i<records->nvertices; i++) records->label[i] = -1;
+  }
+
+  if (records->labellength+length+1>records->maxlabellength) {
+    records->maxlabellength = 2*records->maxlabellength + length + 65536;
+    t = (char*) realloc(records->labeltext,records->maxlabellength);
+    if (t==NULL) return 1;
+    records->labeltext = t;
+  }
+  memcpy(records->labeltext+records->labellength,text,length);
+  records->labeltext[records->labellength+length] = '\0';
+  records->label[records->nvertices-1] = records->labellength;
+  records->labellength += length + 1;
+
+  return 0;
+}
+
+
+// Function to make space for one more edge record and store it.  The
+// weight array is only created once the first weight is met, with the
+// earlier edges set to the default weight of 1.  Returns 1 if memory could
+// not be allocated, otherwise 0.
+
+int add_edge(RECORDS *records, int64_t source, int64_t target, double weight, int has_weight)
+{
+  int i;
+  int64_t *p;
+  double *w;
+
+  if (records->nedges==records->maxedges) {
+    records->maxedges = 2*records->maxedges + 1024;
+    p = (int64_t*) realloc(records->source,records->maxedges*sizeof(int64_t));
+    if (p==NULL) return 1;
+    records->source = p;
+    p = (int64_t*) realloc(records->target,records->maxedges*sizeof(int64_t));
+    if (p==NULL) return 1;
+    records->target = p;
+    if (records->weight!=NULL) {
+      w = (double*) realloc(records->weight,records->maxedges*sizeof(double));
+      if (w==NULL) return 1;
+      records->weight = w;
+    }
+  }
+
+  if (has_weight) {
+    if (records->weight==NULL) {
+      records->weight = (double*) malloc(records->maxedges*sizeof(double));
+      if (records->weight==NULL) return 1;
+      for (i=0; i<records->nedges; i++) records->weight[i] = 1.0;
+    }
+    if (records->max_weight<weight) records->max_weight = weight;
+    if (records->min_weight>weight) records->min_weight = weight;
+  } else weight = 1.0;
+
+  if (records->weight!=NULL) records->weight[records->nedges] = weight;
+  records->source[records->nedges] = source;
+  records->target[records->nedges] = target;
+  records->nedges++;
+
+  return 0;
+}
+
+
+// Function to compare two IDs
+
+int cmpint(const void *i1p, const void *i2p)
+{
+  int64_t i1 = *(const int64_t*) i1p;
+  int64_t i2 = *(const int64_t*) i2p;
+  if (i1>i2) return 1;
+  if (i1<i2) return -1;
+  return 0;
+}
+
+
+// Function to add a node record for every distinct edge endpoint, for
+// formats that have no node records of their own.  Returns 1 if memory
+// could not be allocated, otherwise 0.
+
+int collect_endpoints(RECORDS *records)
+{
+  int i,n;
+  int64_t *id;
+
+  id = (int64_t*) realloc(records->id,(records->nvertices+2*(size_t) records->nedges+1)*sizeof(int64_t));
+  if (id==NULL) return 1;
+  records->id = id;
+  n = records->nvertices;
+  for (i=0; i<records->nedges; i++) {
+    id[n++] = records->source[i];
+    id[n++] = records->target[i];
+  }
+
+  qsort(id,n,sizeof(int64_t),cmpint);
+  records->nvertices = 0;
+  for (i=0; i<n; i++) {
+    if ((i==0)||(id[i]!=id[i-1])) id[records->nvertices++] = id[i];
+  }
+  records->maxvertices = n + 1;
+
+  return 0;
+}
+
+
+// Function to set the records to empty
+
+void init_records(RECORDS *records)
+{
+  memset(records,0,sizeof(RECORDS));
+  records->directed = -1;
+  records->max_weight = 1;
+  records->min_weight = 1;
+}
+
+
+// Function to free the records again
+
+void free_records(RECORDS *records)
+{
+  free(records->id);
+  free(records->label);
+  free(records->labeltext);
+  free(records->source);
+  free(records->target);
+  free(records->weight);
+  init_records(records);
+}
+
+
+// Function to find the start of the first line that begins at or after
+// position "from" in the text.  Returns the length of the text if there is
+// none.
+
+size_t find_line(const char *text, size_t from, size_t length)
+{
+  const char *p;
+
+  if (from==0) return 0;
+  p = scan_char(text+from-1,text+length,'\n');
+  if (p==text+length) return length;
+  return p + 1 - text;
+}
+
+
+// Function to work out the number of threads to use.  If nthreads is 0 or
+// less, one thread per online processor is used.
+
+int thread_count(int nthreads)
+{
+  if (nthreads<=0) nthreads = (int) sysconf(_SC_NPROCESSORS_ONLN);
+  if (nthreads<=0) nthreads = 1;
+  return nthreads;
+}
+
+
+// Function to split the text of a mapped file into at most "maxchunks"
+// chunks of similar size for the parser threads.  Each split point is
+// moved forward with "find_start" to the start of the next record, so no
+// record is shared between two chunks and parsing the chunks one after the
+// other sees exactly the records of the whole file, in the same order.
+// Streams that are not mapped always form a single chunk.  Returns the
+// number of chunks.
+
+int split_text(READER *reader, CHUNK chunks[], int maxchunks, FINDER find_start)
+{
+  int i,n;
+  size_t start,stop;
+
+  n = maxchunks;
+  if (reader->stream!=NULL) n = 1;
+  if ((size_t) n>reader->len/MINCHUNKLENGTH) n = reader->len/MINCHUNKLENGTH;
+  if (n<1) n = 1;
+
+  for (i=0; i<n; i++) {
+    memset(&chunks[i],0,sizeof(CHUNK));
+    init_records(&chunks[i].records);
+    chunks[i].index = i;
+  }
+  if (n==1) {
+    chunks[0].reader = *reader;
+    return 1;
+  }
+
+  start = 0;
+  for (i=0; i<n; i++) {
+    if (i==n-1) stop = reader->len;
+    else stop = find_start(reader->text,(reader->len/n)*(i+1),reader->len);
+    if (stop<start) stop = start;
+    chunks[i].reader.text = reader->text + start;
+    chunks[i].reader.len = stop - start;
+    start = stop;
+  }
+
+  return n;
+}
+
+
+// Function to run a thread function on every chunk, one thread per chunk,
+// and wait for them all.  Returns 1 if any chunk failed, otherwise 0.
+
+int run_chunks(void *(*work)(void*), CHUNK chunks[], int nchunks)
+{
+  int i;
+  pthread_t *threads;
+
+  threads = (pthread_t*) malloc(nchunks*sizeof(pthread_t));
+  if (threads==NULL) return 1;
+
+  // The calling thread takes the first chunk itself; if a thread cannot
+  // be started its chunk is also done here
+
+  for (i=1; i<nchunks; i++) {
+    if (pthread_create(&threads[i],NULL,work,&chunks[i])!=0) {
+      threads[i] = 0;
+      work(&chunks[i]);
+    }
+  }
+  work(&chunks[0]);
+  for (i=1; i<nchunks; i++) {
+    if (threads[i]!=0) pthread_join(threads[i],NULL);
+  }
+  free(threads);
+
+  for (i=0; i<nchunks; i++) {
+    if (chunks[i].result!=0) return 1;
+  }
+  return 0;
+}
+
+
+// Function to compare the IDs of two vertices.  Vertices with the same ID
+// are kept in file order, which create_network() leaves in their degrees
+// while it sorts them.
+
+int cmpid(const void *v1p, const void *v2p)
+{
+  VERTEX *v1 = (VERTEX*) v1p;
+  VERTEX *v2 = (VERTEX*) v2p;
+  if (v1->id>v2->id) return 1;
+  if (v1->id<v2->id) return -1;
+  return v1->degree - v2->degree;
+}
+
+
+// Function to hash a label (FNV-1a)
+
+uint64_t hash_label(const char *text)
+{
+  uint64_t h = 14695981039346656037ULL;
+
+  while (*text!='\0') {
+    h ^= (unsigned char) *text++;
+    h *= 1099511628211ULL;
+  }
+  return h;
+}
+
+
+// Function to gather the labels of the node records into a single arena
+// for the network, in vertex order.  Each vertex's degree holds the number
+// of its node record in the file.  Labels that are the same are stored
+// only once, found with an open-addressing hash table of their offsets.
+// Returns 1 if memory runs out, otherwise 0.
+
+int create_labels(NETWORK *network, CHUNK chunks[], int nchunks)
+{
+  int i,c,r;
+  int nlabels=0;
+  size_t length=0,size,slot;
+  long *table;
+  const char *text;
+  RECORDS *records;
+
+  for (c=0; c<nchunks; c++) {
+    records = &chunks[c].records;
+    if (records->label==NULL) continue;
+    for (i=0; i<records->nvertices; i++) nlabels += (records->label[i]>=0);
+    length += records->labellength;
+  }
+  if (nlabels==0) return 0;
+
+  network->label = (long*) malloc(network->nvertices*sizeof(long));
+  network->labels = (char*) malloc(length);
+  size = 2;
+  while (size<2*(size_t) nlabels) size *= 2;
+  table = (long*) malloc(size*sizeof(long));
+  if ((network->label==NULL)||(network->labels==NULL)||(table==NULL)) {
+    free(table);
+    return 1;
+  }
+  for (slot=0; slot<size; slot++) table[slot] = -1;
+
+  length = 0;
+  c = 0;
+  r = 0;
+  for (i=0; i<network->nvertices; i++) {
+    network->label[i] = -1;
+
+    // Find the chunk and position of the vertex's node record
+
+    r = network->vertex[i].degree;
+    for (c=0; (c<nchunks-1)&&(r>=chunks[c].records.nvertices); c++)
+      r -= chunks[c].records.nvertices;
+    records = &chunks[c].records;
+    if ((records->label==NULL)||(records->label[r]<0)) continue;
+    text = records->labeltext + records->label[r];
+
+    slot = hash_label(text) & (size-1);
+    while ((table[slot]>=0)&&(strcmp(network->labels+table[slot],text)!=0))
+      slot = (slot+1) & (size-1);
+    if (table[slot]<0) {
+      table[slot] = length;
+      strcpy(network->labels+length,text);
+      length += strlen(text) + 1;
+    }
+    network->label[i] = table[slot];
+  }
+  free(table);
+
+  // Give back the space of the repeated labels
+
+  text = (char*) realloc(network->labels,length);
+  if (text!=NULL) network->labels = (char*) text;
+
+  return 0;
+}
+
+
+// Function to allocate space for the vertices of the network and set their
+// IDs and labels from the node records of all chunks, in file order.
+// Later "directed" settings override earlier ones.  If merge_ids is set,
+// vertices with the same ID are merged into the first of them.  Returns 1
+// on failure, otherwise 0.
+
+int create_network(NETWORK *network, CHUNK chunks[], int nchunks, int merge_ids)
+{
+  int i,c,n;
+  RECORDS *records;
+
+  network->directed = 0;
+  network->nvertices = 0;
+  network->nedges = 0;
+  network->MAX_Weight = 1;
+  network->MIN_Weight = 1;
+
+  for (c=0; c<nchunks; c++) {
+    records = &chunks[c].records;
+    if (records->directed>=0) network->directed = records->directed;
+    if (network->MAX_Weight<records->max_weight) network->MAX_Weight = records->max_weight;
+    if (network->MIN_Weight>records->min_weight) network->MIN_Weight = records->min_weight;
+    network->nvertices += records->nvertices;
+  }
+
+  // Make space for the vertices.  Until the edges are counted, the degree
+  // of each vertex holds the number of its node record.
+
+  network->vertex = (VERTEX*) calloc(network->nvertices,sizeof(VERTEX));
+  if ((network->vertex==NULL)&&(network->nvertices>0)) return 1;
+
+  n = 0;
+  for (c=0; c<nchunks; c++) {
+    records = &chunks[c].records;
+    for (i=0; i<records->nvertices; i++) {
+      network->vertex[n].id = records->id[i];
+      network->vertex[n].degree = n;
+      n++;
+    }
+
+    // The node IDs are not needed any more
+
+    free(records->id);
+    records->id = NULL;
+  }
+
+  // Sort the vertices in increasing order of their IDs, unless they are
+  // in order already as they usually are
+
+  for (i=1; i<network->nvertices; i++) {
+    if (network->vertex[i].id<network->vertex[i-1].id) break;
+  }
+  if (i<network->nvertices) qsort(network->vertex,network->nvertices,sizeof(VERTEX),cmpid);
+
+  if (merge_ids) {
+    n = 0;
+    for (i=0; i<network->nvertices; i++) {
+      if ((n==0)||(network->vertex[i].id!=network->vertex[n-1].id))
+        network->vertex[n++] = network->vertex[i];
+    }
+    network->nvertices = n;
+  }
+
+  if (create_labels(network,chunks,nchunks)) return 1;
+  for (i=0; i<network->nvertices; i++) network->vertex[i].degree = 0;
+
+  return 0;
+}
+
+
+// Thread function to replace the GML IDs of the edge endpoints of one chunk
+// by vertex indices, looked up in the ID map, and to count the degrees they
+// add.  If the chunk has its own count array the degrees are counted there,
+// otherwise they are added to the shared degrees atomically.
+
+void *resolve_chunk(void *arg)
+{
+  int i;
+  int vs,vt;
+  CHUNK *chunk = (CHUNK*) arg;
+  RECORDS *records = &chunk->records;
+  NETWORK *network = chunk->network;
+  int *count = chunk->count;
+
+  for (i=0; i<records->nedges; i++) {
+    vs = idmap_find(chunk->idmap,records->source[i]);
+    vt = idmap_find(chunk->idmap,records->target[i]);
+    if ((vs<0)||(vt<0)) {
+      chunk->result = 1;
+      return NULL;
+    }
+    records->source[i] = vs;
+    records->target[i] = vt;
+    if (count!=NULL) {
+      count[vs]++;
+      if (network->directed==0) count[vt]++;
+    } else {
+      __sync_fetch_and_add(&network->vertex[vs].degree,1);
+      if (network->directed==0) __sync_fetch_and_add(&network->vertex[vt].degree,1);
+    }
+  }
+
+  return NULL;
+}
+
+
+// Thread function to copy the resolved edge records of one chunk into the
+// edge block.  The count array of the chunk holds the next free slot of
+// each vertex, so the chunks fill disjoint slots and every vertex sees its
+// edges in file order.
+
+void *fill_chunk(void *arg)
+{
+  int i;
+  int vs,vt;
+  double w;
+  CHUNK *chunk = (CHUNK*) arg;
+  RECORDS *records = &chunk->records;
+  NETWORK *network = chunk->network;
+  EDGE *edges = network->edges;
+  int *slot = chunk->count;
+
+  for (i=0; i<records->nedges; i++) {
+    vs = records->source[i];
+    vt = records->target[i];
+    w = (records->weight==NULL) ? 1.0 : records->weight[i];
+    edges[slot[vs]].target = vt;
+    edges[slot[vs]].weight = w;
+    slot[vs]++;
+    if (network->directed==0) {
+      edges[slot[vt]].target = vs;
+      edges[slot[vt]].weight = w;
+      slot[vt]++;
+    }
+  }
+
+  return NULL;
+}
+
+
+// Function to build the edges of the network in compressed sparse row form
+// from the edge records of all chunks: one block holds the edges of vertex
+// 0, then those of vertex 1, and so on.  This is a counting sort of the
+// records by source vertex.  When every chunk has its own count array the
+// counts are turned into per-chunk starting slots and the chunks are
+// copied in parallel; otherwise the chunks are copied one after the other.
+// Either way every vertex sees its edges in file order.  Returns 1 if
+// memory runs out, otherwise 0.
+
+int build_edges(NETWORK *network, CHUNK chunks[], int nchunks)
+{
+  int i,c;
+  int parallel;
+  size_t total,start;
+
+  parallel = (chunks[0].count!=NULL);
+  network->nedges = 0;
+  for (c=0; c<nchunks; c++) network->nedges += chunks[c].records.nedges;
+
+  // Degrees and the start of each vertex's edges in the block
+
+  total = 0;
+  for (i=0; i<network->nvertices; i++) {
+    if (parallel) {
+      network->vertex[i].degree = 0;
+      for (c=0; c<nchunks; c++) {
+        start = total + network->vertex[i].degree;
+        network->vertex[i].degree += chunks[c].count[i];
+        chunks[c].count[i] = (int) start;
+      }
+    }
+    total += network->vertex[i].degree;
+  }
+
+  network->edges = (EDGE*) malloc(total*sizeof(EDGE));
+  if ((network->edges==NULL)&&(total>0)) return 1;
+
+  total = 0;
+  for (i=0; i<network->nvertices; i++) {
+    network->vertex[i].edge = network->edges + total;
+    total += network->vertex[i].degree;
+  }
+
+  if (parallel) return run_chunks(fill_chunk,chunks,nchunks);
+
+  // One chunk at a time, sharing one array of free slots
+
+  chunks[0].count = (int*) malloc(network->nvertices*sizeof(int));
+  if ((chunks[0].count==NULL)&&(network->nvertices>0)) return 1;
+  for (i=0; i<network->nvertices; i++)
+    chunks[0].count[i] = network->vertex[i].edge - network->edges;
+  for (c=0; c<nchunks; c++) {
+    chunks[c].count = chunks[0].count;
+    fill_chunk(&chunks[c]);
+  }
+  for (c=1; c<nchunks; c++) chunks[c].count = NULL;
+
+  return 0;
+}
+
+
+// Function to give every chunk its own count array for the degrees, if
+// there is more than one chunk and the arrays take no more space than the
+// edges themselves.  Otherwise the degrees are counted in the vertices.
+// Returns 1 if memory runs out, otherwise 0.
+
+int alloc_counts(NETWORK *network, CHUNK chunks[], int nchunks)
+{
+  int c;
+  size_t nentries=0;
+
+  for (c=0; c<nchunks; c++) nentries += chunks[c].records.nedges;
+  if (network->directed==0) nentries *= 2;
+  if ((nchunks<2)||((size_t) nchunks*network->nvertices>nentries)) return 0;
+
+  for (c=0; c<nchunks; c++) {
+    chunks[c].count = (int*) calloc(network->nvertices,sizeof(int));
+    if (chunks[c].count==NULL) return 1;
+  }
+
+  return 0;
+}
+
+
+// Function to read a complete network from the text of a reader.  The
+// text is split into chunks with "find_start", each chunk is parsed by the
+// thread function "parse" into its records, and the network is built from
+// the records of all chunks.  "context" is handed to every chunk.  Returns
+// 1 on failure, otherwise 0.
+
+int read_chunks(NETWORK *network, READER *reader, int nthreads, FINDER find_start,
+                void *(*parse)(void*), void *context, int merge_ids)
+{
+  int c,nchunks;
+  int result;
+  CHUNK *chunks;
+  IDMAP idmap;
+
+  network->nvertices = 0;
+  network->vertex = NULL;
+  network->edges = NULL;
+  network->labels = NULL;
+  network->label = NULL;
+
+  nthreads = thread_count(nthreads);
+  chunks = (CHUNK*) malloc(nthreads*sizeof(CHUNK));
+  if (chunks==NULL) return 1;
+  nchunks = split_text(reader,chunks,nthreads,find_start);
+  memset(&idmap,0,sizeof(IDMAP));
+  for (c=0; c<nchunks; c++) {
+    chunks[c].network = network;
+    chunks[c].idmap = &idmap;
+    chunks[c].context = context;
+  }
+
+  // Parse the chunks, then build the vertex array and the ID map from all
+  // the node records before the edges of each chunk can be resolved
+
+  result = run_chunks(parse,chunks,nchunks);
+  if ((reader->decoder!=NULL)&&reader->decoder->error) result = 1;
+  if (result==0) result = create_network(network,chunks,nchunks,merge_ids);
+  if (result==0) result = build_idmap(&idmap,network->vertex,network->nvertices);
+  if (result==0) result = alloc_counts(network,chunks,nchunks);
+  if (result==0) result = run_chunks(resolve_chunk,chunks,nchunks);
+  free_idmap(&idmap);
+  if (result==0) result = build_edges(network,chunks,nchunks);
+
+  for (c=0; c<nchunks; c++) {
+    free_records(&chunks[c].records);
+    free(chunks[c].count);
+  }
+  free(chunks);
+
+  if (result!=0) {
+    free(network->edges);
+    free(network->vertex);
+    free(network->labels);
+    free(network->label);
+    network->edges = NULL;
+    network->vertex = NULL;
+    network->labels = NULL;
+    network->label = NULL;
+    network->nvertices = 0;
+  }
+  return result;
+}
@@ -28,51 +28,209 @@ THE SOFTWARE.
 // Various checks are performed on the user input but kind handling is expected.
 
 #include "readgml.h"
+#include "readnet.h"
+#include "snapshot.h"
+#include "simplify.h"
+#include "csr.h"
+#include "reorder.h"
+#include "components.h"
+#include "placement.h"
+#include "sharedgraph.h"
 #include "betweenness.h"
 #include "kpath.h"
 
+typedef struct {
+	char *snapshot;				// File to save a binary snapshot of the network to, or NULL
+	int format;					// Input format, one of the FORMAT_ constants of readnet.h
+	int threads;				// Number of threads used to parse the input and take the k-path walks, 0 for all processors
+	int duplicates;				// What to do with repeated edges, one of the DUPLICATES_ constants of simplify.h
+	int selfloops;				// What to do with self-loops, one of the SELFLOOPS_ constants of simplify.h
+	int ids;					// 1 to print the GML id and label of each vertex next to its index
+	int order;					// How to relabel the vertices for cache locality, one of the ORDER_ constants of reorder.h
+	int compress;				// 1 to pack the neighbor lists of unweighted networks (see csr.h)
+	int placement;				// Where to put the graph arrays on a NUMA machine, one of the PLACE_ constants of placement.h
+	int hugepages;				// 1 to back the graph arrays with transparent huge pages
+	int pin;					// 1 to pin the algorithms to one CPU
+	char *publish;				// Shared segment to publish the graph to, or NULL
+	int attach;					// 1 if the input is the name of a shared segment to attach to
+	ui64 seed;					// Seed of the random numbers of the samplers, the time unless given
+} OPTIONS;
+
+int user_options(int argc, char *argv[], OPTIONS *options); 
 void user_inputs(f64 &alpha, ui64 &plength, NETWORK *network, char *argv[]); 
-void Print (f64 CB[], f64 NOV [ ], NETWORK *network, FILE *OutPtr ); 
+void Print (f64 CB[], f64 NOV [ ], NETWORK *network, int ids, FILE *OutPtr ); 
+void PrintVertex (ui64 i, NETWORK *network, int ids, FILE *OutPtr ); 
+f64 Seconds (); 
+ui64 ListBytes (CSR *graph); 
 
 /* 
  * Main function 
  */
 int main (int argc, char *argv[]) {
 	
-	ui64 i, plength = 0, nvertices = 0, nedges = 0;
-	f64 alpha, brandes_time = 0, kpath_time = 0;
+	ui64 i, plength = 0, nvertices = 0, nedges = 0, lists;
+	f64 alpha, brandes_time = 0, kpath_time = 0, reorder_time = 0;
 	f64 *CB, *NOV;
 	FILE *InPtr, *OutPtr; 
 	NETWORK network; 
+	CSR graph; 
+	COMPONENTS components; 
+	uint32_t *perm; 
+	OPTIONS options; 
+	SIMPLIFY_REPORT report; 
+	int result; 
+	
+	// Separate the options from the other command-line arguments
+	argc = user_options(argc, argv, &options); 
 	
 	// Check command-line arguments 
-	if (argc < 5) { 
-		cout << "Usage: ./kpath_centrality <infile.gml> <outfile.csv> <k-path alpha> <k-path length> " << endl;
+	if ((argc < 5) && !((argc == 2) && ((options.snapshot != NULL) || (options.publish != NULL)) && !options.attach)) { 
+		cout << "Usage: ./kpath_centrality [options] <infile> <outfile.csv> <k-path alpha> <k-path length> " << endl;
+		cout << "       ./kpath_centrality [options] --save-snapshot <outfile.csr> <infile>" << endl;
+		cout << "       ./kpath_centrality [options] --publish <name> <infile>" << endl;
+		cout << "Options: --format gml|edgelist|snap|mtx|snapshot  --threads <n>  --save-snapshot <outfile.csr>" << endl;
+		cout << "         --duplicates keep|drop|sum  --self-loops keep|drop  --ids  --reorder none|degree|rcm|gorder" << endl;
+		cout << "         --compress  --placement local|interleave|partition|replicate  --hugepages  --pin" << endl;
+		cout << "         --publish <name>  --attach (<infile> is then the name of a published graph)  --seed <n>" << endl;
 		exit(1);
 	}
 
-	// Open the gml file 
-	InPtr = fopen(argv[1], "r"); 
-	if (InPtr == NULL) {
-		cout << "Unable to open the input file" << endl; 
-		return 0; 
+	// Load the network, or attach to a graph another process published 
+	if (options.attach) {
+		// Attach to a graph another process published; it is used as it was published 
+		if (attach_graph(argv[1], &network, &graph, &perm) != 0) {
+			cout << "Unable to attach to the shared graph " << argv[1] << endl; 
+			return 0; 
+		}
+		cout << "Attached to the shared graph " << argv[1] << endl; 
+		if ((options.order != ORDER_NONE) || options.compress) 
+			cout << "The shared graph is used as it was published, without reordering or compressing it again" << endl; 
+		options.order = ORDER_NONE; 
 	}
+	else {
+		// Open the input file
+		InPtr = fopen(argv[1], "r"); 
+		if (InPtr == NULL) {
+			cout << "Unable to open the input file" << endl; 
+			return 0; 
+		}
 	
-	// Read the gml file and create the network 
-	if (read_network(&network, InPtr) != 0) {
-		cout << "Error creating the network" << endl; 
-		return 0; 
-	}
+		// Read the input file and create the network 
+		result = read_any_network(&network, InPtr, argv[1], options.format, options.threads); 
+		if (result != 0) {
+			cout << "Error creating the network" << endl; 
+			return 0; 
+		}
+	
+		// Close the input file
+		fclose(InPtr); 
+	
+		// Remove repeated edges and self-loops if asked to
+		if (simplify_network(&network, options.duplicates, options.selfloops, options.threads, &report) != 0) {
+			cout << "Error creating the network" << endl; 
+			return 0; 
+		}
+		if ((report.selfloops > 0) || (report.duplicates > 0)) 
+			cout << "Removed " << report.selfloops << " self-loops and " << report.duplicates << " repeated edges" << endl; 
+	
+		// Save a snapshot of the network if asked to, and stop if that was all
+		if (options.snapshot != NULL) {
+			OutPtr = fopen(options.snapshot, "wb"); 
+			if ((OutPtr == NULL) || (write_snapshot(&network, OutPtr) != 0)) 
+				cout << "Unable to write the snapshot file" << endl; 
+			else 
+				cout << "Snapshot of the network written to " << options.snapshot << endl; 
+			if (OutPtr != NULL) 
+				fclose(OutPtr); 
+			if ((argc == 2) && (options.publish == NULL)) {
+				free_network(&network); 
+				return 0; 
+			}
+		}
+	
+		// Build the compressed sparse row form of the network that the algorithms run on
+		if (build_csr(&graph, &network) != 0) {
+			cout << "Allocating memory failed" << endl; 
+			free_network(&network); 
+			return 0; 
+		}
+	
+		// Only the ids and labels of the network are needed from here on, so let its edges go before the lists are reordered or packed
+		free_edges(&network); 
+	
+		// Relabel the vertices for cache locality if asked to; the results are put back in the input order before printing
+		reorder_time = Seconds(); 
+		if (reorder_csr(&graph, options.order, &perm) != 0) {
+			cout << "Allocating memory failed" << endl; 
+			free_csr(&graph); 
+			free_network(&network); 
+			return 0; 
+		}
+		reorder_time = Seconds() - reorder_time; 
+		if (options.order != ORDER_NONE) 
+			cout << "It took " << reorder_time << " seconds to reorder the vertices" << endl; 
+	
+		// Build the in-edges of a directed network, among which the betweenness algorithms look up predecessors
+		if (graph.directed && (reverse_csr(&graph, options.threads) != 0)) {
+			cout << "Allocating memory failed" << endl; 
+			free(perm); 
+			free_csr(&graph); 
+			free_network(&network); 
+			return 0; 
+		}
+	
+		// Pack the neighbor lists if asked to; only the breadth-first kernels can read them
+		if (options.compress) {
+			lists = ListBytes(&graph); 
+			if (graph.weights != NULL) 
+				cout << "The neighbor lists are only compressed for unweighted networks" << endl; 
+			else if (compress_csr(&graph) != 0) 
+				cout << "Compressing the neighbor lists failed, keeping them as they are" << endl; 
+			else 
+				cout << "Compressed the neighbor lists from " << lists << " to " << ListBytes(&graph) << " bytes" << endl; 
+		}
 	
-	// Close the gml file
-	fclose(InPtr); 
+		// Publish the graph for other processes to attach to if asked to, and stop if that was all
+		if (options.publish != NULL) {
+			if (publish_graph(options.publish, &network, &graph, perm, options.hugepages) != 0) 
+				cout << "Unable to publish the graph" << endl; 
+			else 
+				cout << "Graph published to the shared segment " << options.publish << endl; 
+			if (argc == 2) {
+				free(perm); 
+				free_csr(&graph); 
+				free_network(&network); 
+				return 0; 
+			}
+		}
+	}
 	
 	// Display the number of vertices and number of edges 
 	nvertices = network.nvertices; 
 	nedges = network.nedges; 
 	cout << "Number of vertices =  " << nvertices << "  and number of edges == " << nedges << endl; 
 	cout << "Maximum weight = " << network.MAX_Weight << " and " << "Minimum weight = " << network.MIN_Weight << endl; 
-	cout << "Network is directed(1) OR undirected(0) = " << network.directed << endl; 
+	cout << "Network is directed(1) OR undirected(0) = " << network.directed << endl;
+	
+	// Find the connected components: the algorithms draw their sources from them and fill in the trivial ones directly 
+	if (find_components(&components, &graph, options.threads) != 0) {
+		cout << "Allocating memory failed" << endl; 
+		free(perm); 
+		free_csr(&graph); 
+		free_network(&network); 
+		return 0; 
+	}
+	cout << "Found " << components.ncomponents << " connected components, with " << nvertices - components.nsources << " vertices in isolated vertices, pairs and trees" << endl; 
+	
+	// Keep the algorithms on one CPU if asked to, then place the graph arrays on the memory nodes 
+	if (options.pin && (pin_thread(0) != 0)) 
+		cout << "Pinning the algorithms to a CPU failed" << endl; 
+	if ((options.placement != PLACE_LOCAL) || (options.hugepages && !options.attach)) {
+		if (place_csr(&graph, options.placement, options.hugepages) != 0) 
+			cout << "Placing the graph arrays failed, keeping them where they are" << endl; 
+		else 
+			cout << "Placed the graph arrays on " << numa_nodes() << " memory node(s)" << endl; 
+	}
 	
 	// Allocate memory for CB == Betweenness Centrality and NOV == Number of Visits for K-Path Centrality
 	CB = (f64 *) calloc (nvertices, sizeof(f64)); 
@@ -82,6 +240,9 @@ int main (int argc, char *argv[]) {
 		cout << "Allocating memory failed" << endl; 
 		free(CB); 
 		free(NOV); 
+		free(perm); 
+		free_components(&components); 
+		free_csr(&graph); 
 		free_network(&network); 
 		return 0; 
 	}
@@ -102,26 +263,40 @@ int main (int argc, char *argv[]) {
 		return 0; 
 	}
 	
+	// Print the seed, with which the random estimates can be repeated 
+	cout << "Random seed = " << options.seed << endl; 
+	
+	// The algorithms read the copy of the graph on their own node when it is replicated 
 	//Compute and print betweenness centrality
-	BrandesAlgorithm(CB, &network, brandes_time);
+	BrandesAlgorithm(CB, local_csr(&graph), &components, brandes_time);
 
-	//Compute and print k-path centrality
-	kpathcentrality(NOV, &network, alpha, plength, kpath_time); 
+	//Compute and print k-path centrality, on every thread asked for; each thread finds the copy of the graph on its node itself
+	kpathcentrality(NOV, &graph, &components, alpha, plength, options.threads, options.pin, options.seed, kpath_time); 
+	
+	// Put the results back in the order of the input 
+	if ((restore_order(CB, perm, nvertices) != 0) || (restore_order(NOV, perm, nvertices) != 0)) 
+		cout << "Allocating memory failed, the results are printed for the relabelled vertices" << endl; 
 	
 	//Write file header
 	fprintf(OutPtr, "Input file name:," );
 	fprintf(OutPtr, "%s", argv[1] );
 	fprintf(OutPtr, ",nvertices:,%ld,nedges:,%ld,directed:,%ld,", (ui64) network.nvertices, (ui64) network.nedges, (ui64) network.directed );
 	fprintf(OutPtr, "max_weight:,%f,min_weight:,%f\n", network.MAX_Weight, network.MIN_Weight );
-	fprintf(OutPtr, "alpha:,%f,plength:%ld\n", alpha, plength);
-	fprintf(OutPtr, "Brandes time:,%f,kpath time:,%f\n", brandes_time, kpath_time); 
-	fprintf(OutPtr, "Vertex,Brandes,KPath\n"); 
+	fprintf(OutPtr, "alpha:,%f,plength:%ld,seed:,%lu\n", alpha, plength, options.seed);
+	fprintf(OutPtr, "Brandes time:,%f,kpath time:,%f", brandes_time, kpath_time); 
+	if (options.order != ORDER_NONE) 
+		fprintf(OutPtr, ",reorder time:,%f", reorder_time); 
+	fprintf(OutPtr, "\n"); 
+	fprintf(OutPtr, "Vertex,%sBrandes,KPath\n", options.ids ? "Id,Label," : ""); 
 	
-	Print(CB, NOV, &network, OutPtr);
+	Print(CB, NOV, &network, options.ids, OutPtr);
 	
 	//Free memory
 	free(CB);
 	free(NOV);
+	free(perm);
+	free_components(&components);
+	free_csr(&graph);
 	free_network(&network);
 	fclose(OutPtr); 
 	cout << "Done" << endl; 
@@ -129,6 +304,93 @@ int main (int argc, char *argv[]) {
 	
 } // End Main 
 
+/* 
+ * User options - remove the "--" options from argv and return the number of arguments left
+ */ 
+int user_options(int argc, char *argv[], OPTIONS *options) {
+	
+	int i, n = 1; 
+	
+	options->snapshot = NULL; 
+	options->format = FORMAT_AUTO; 
+	options->threads = 0; 
+	options->duplicates = DUPLICATES_KEEP; 
+	options->selfloops = SELFLOOPS_KEEP; 
+	options->ids = 0; 
+	options->order = ORDER_NONE; 
+	options->compress = 0; 
+	options->placement = PLACE_LOCAL; 
+	options->hugepages = 0; 
+	options->pin = 0; 
+	options->publish = NULL; 
+	options->attach = 0; 
+	options->seed = (ui64) time(NULL); 
+	
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "--save-snapshot") == 0) && (i + 1 < argc)) 
+			options->snapshot = argv[++i]; 
+		else if ((strcmp(argv[i], "--format") == 0) && (i + 1 < argc)) {
+			options->format = network_format(argv[++i]); 
+			if (options->format < 0) {
+				cout << "Unknown input format: " << argv[i] << " (use gml, edgelist, snap, mtx or snapshot)" << endl; 
+				exit(1); 
+			}
+		}
+		else if ((strcmp(argv[i], "--threads") == 0) && (i + 1 < argc)) 
+			options->threads = atoi(argv[++i]); 
+		else if ((strcmp(argv[i], "--duplicates") == 0) && (i + 1 < argc)) {
+			options->duplicates = duplicates_policy(argv[++i]); 
+			if (options->duplicates < 0) {
+				cout << "Unknown policy for repeated edges: " << argv[i] << " (use keep, drop or sum)" << endl; 
+				exit(1); 
+			}
+		}
+		else if ((strcmp(argv[i], "--self-loops") == 0) && (i + 1 < argc)) {
+			options->selfloops = selfloops_policy(argv[++i]); 
+			if (options->selfloops < 0) {
+				cout << "Unknown policy for self-loops: " << argv[i] << " (use keep or drop)" << endl; 
+				exit(1); 
+			}
+		}
+		else if (strcmp(argv[i], "--ids") == 0) 
+			options->ids = 1; 
+		else if ((strcmp(argv[i], "--reorder") == 0) && (i + 1 < argc)) {
+			options->order = order_method(argv[++i]); 
+			if (options->order < 0) {
+				cout << "Unknown vertex ordering: " << argv[i] << " (use none, degree, rcm or gorder)" << endl; 
+				exit(1); 
+			}
+		}
+		else if (strcmp(argv[i], "--compress") == 0) 
+			options->compress = 1; 
+		else if ((strcmp(argv[i], "--placement") == 0) && (i + 1 < argc)) {
+			options->placement = placement_policy(argv[++i]); 
+			if (options->placement < 0) {
+				cout << "Unknown placement: " << argv[i] << " (use local, interleave, partition or replicate)" << endl; 
+				exit(1); 
+			}
+		}
+		else if (strcmp(argv[i], "--hugepages") == 0) 
+			options->hugepages = 1; 
+		else if (strcmp(argv[i], "--pin") == 0) 
+			options->pin = 1; 
+		else if ((strcmp(argv[i], "--publish") == 0) && (i + 1 < argc)) 
+			options->publish = argv[++i]; 
+		else if (strcmp(argv[i], "--attach") == 0) 
+			options->attach = 1; 
+		else if ((strcmp(argv[i], "--seed") == 0) && (i + 1 < argc)) 
+			options->seed = (ui64) strtoull(argv[++i], NULL, 0); 
+		else if (strncmp(argv[i], "--", 2) == 0) {
+			cout << "Unknown option or missing value: " << argv[i] << endl; 
+			exit(1); 
+		}
+		else 
+			argv[n++] = argv[i]; 
+	}
+	
+	return n; 
+} // End user_options
+
 /* 
  * User inputs - alpha, plength 
  */ 
@@ -163,13 +425,69 @@ void user_inputs(f64 &alpha, ui64 &plength, NETWORK *network, char *argv[]) {
 /*
  * Print All centrality values
  */ 
-void Print (f64 CB[], f64 NOV [ ], NETWORK *network, FILE *OutPtr) {
+void Print (f64 CB[], f64 NOV [ ], NETWORK *network, int ids, FILE *OutPtr) {
 
 	ui64 i; 
 	
 	for ( i = 0; i < (ui64) network->nvertices; i++ ) {
-		fprintf(OutPtr, "%lu,%f,%f\n", i, CB[i], NOV[i]); 
+		PrintVertex(i, network, ids, OutPtr); 
+		fprintf(OutPtr, "%f,%f\n", CB[i], NOV[i]); 
+	}
+	
+	return; 
+}
+
+/*
+ * Print the first columns of a vertex: its index and, if asked for, its GML id and its
+ * label as a quoted CSV field
+ */ 
+void PrintVertex (ui64 i, NETWORK *network, int ids, FILE *OutPtr) {
+
+	const char *label; 
+	
+	fprintf(OutPtr, "%lu,", i); 
+	if (!ids) 
+		return; 
+	fprintf(OutPtr, "%lld,", (long long) network->vertex[i].id); 
+	label = vertex_label(network, (int) i); 
+	if (label != NULL) {
+		fputc('"', OutPtr); 
+		for ( ; *label != '\0'; label++) {
+			if (*label == '"') 
+				fputc('"', OutPtr); 
+			fputc(*label, OutPtr); 
+		}
+		fputc('"', OutPtr); 
 	}
+	fputc(',', OutPtr); 
 	
 	return; 
 }
+
+/*
+ * Wall-clock time in seconds, for timing the stages that take less than a second
+ */ 
+f64 Seconds () {
+	
+	struct timespec now; 
+	
+	clock_gettime(CLOCK_MONOTONIC, &now); 
+	return (f64) now.tv_sec + (f64) now.tv_nsec / 1e9; 
+}
+
+/*
+ * Bytes taken by the neighbor lists of a graph and of its in-edges, with their offsets if they are packed
+ */ 
+ui64 ListBytes (CSR *graph) {
+	
+	ui64 n = (ui64) graph->nvertices; 
+	ui64 bytes; 
+	
+	if (graph->packed != NULL) 
+		bytes = graph->packedoffsets[n] + (n + 1) * sizeof(uint64_t); 
+	else 
+		bytes = (ui64) graph->nedges * sizeof(uint32_t); 
+	if (graph->reverse != NULL) 
+		bytes += ListBytes(graph->reverse); 
+	return bytes; 
+}
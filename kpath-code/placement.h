@@ -0,0 +1,113 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Placement of the graph arrays on the memory nodes of a NUMA machine
+//
+// On a machine with several sockets each one has its own memory, and a
+// thread reads the memory of another socket at a fraction of the speed.
+// The arrays of a CSR graph are filled in by the thread that builds them,
+// so all of them normally sit on one node.  place_csr() copies them into
+// new arrays placed by one of these policies:
+//
+//   PLACE_LOCAL        leave them where they are
+//   PLACE_INTERLEAVE   spread their pages over all the nodes in turn, so
+//                      that every socket pays the same average cost
+//   PLACE_PARTITION    cut the vertices into one range per node, with about
+//                      the same number of edges in each, and put the part
+//                      of every array that belongs to a range on its node
+//   PLACE_REPLICATE    keep a whole copy of the graph on every node; a
+//                      thread finds the copy on its own node with
+//                      local_csr()
+//
+// The state the algorithms keep for each of their threads follows the
+// graph: place_state() puts it on the node of the thread that asks for
+// it, unless the graph was left where it was, and on huge pages if the
+// graph is.
+//
+// The arrays can also be backed by transparent huge pages, which saves
+// TLB misses on the random accesses of the searches.  With libnuma
+// (HAVE_NUMA) the nodes are found and the memory bound through it;
+// without it the mbind system call is used directly and the nodes are
+// read from /sys.  On a machine with one node, or where binding is not
+// allowed, the arrays are still copied and everything works as before.
+//
+// Function calls:
+//   int placement_policy(const char *name)
+//     -- Returns the PLACE_ constant for a name given on the command line
+//        ("local", "interleave", "partition" or "replicate"), or -1 if it
+//        is not known
+//   int place_csr(CSR *graph, int policy, int hugepages)
+//     -- Moves the arrays of "graph", and those of its in-edges, as the
+//        policy says, on huge pages if "hugepages" is set.  Call it after
+//        reorder_csr(), reverse_csr() and compress_csr(), which replace
+//        the arrays.  A graph attached to a shared segment (see
+//        "sharedgraph.h") gets private copies.  The original arrays are
+//        given back; a replicated graph is left pointing at the arrays of
+//        its copy on node 0.  Returns 0 if successful, 1 if memory runs
+//        out, in which case the arrays of the graph itself are unchanged
+//   void *place_state(const CSR *graph, size_t bytes)
+//     -- Allocates "bytes" of zeroed memory for the state of the calling
+//        thread, bound to the node it runs on unless the arrays of
+//        "graph" were left where they are, and on huge pages if theirs
+//        are.  Free it with free().  Returns NULL if memory runs out
+//   int place_edges(const CSR *graph, size_t width, void *copies[])
+//     -- Allocates an array of "width" bytes for each edge of "graph",
+//        placed as its targets are: for a replicated graph one on each
+//        node, in copies[0] to copies[graph->nreplicas-1] in the order of
+//        the copies of the graph, otherwise a single one in copies[0].
+//        The arrays are left to be filled in; each page goes to its node
+//        when it is first written.  Free each with free().  Returns 0 if
+//        successful, 1 if memory runs out, with nothing left allocated
+//   CSR *local_csr(CSR *graph)
+//     -- Returns the copy of "graph" on the node of the calling thread, or
+//        "graph" itself if it is not replicated
+//   int numa_nodes()
+//     -- Returns the number of memory nodes, at least 1
+//   int pin_thread(int index)
+//     -- Pins the calling thread to one CPU.  Threads with consecutive
+//        indices are spread over the nodes in turn.  Returns 0 if
+//        successful
+
+#ifndef PLACEMENT_H
+#define PLACEMENT_H
+
+#include "csr.h"
+
+// Placement policies
+
+enum { PLACE_LOCAL, PLACE_INTERLEAVE, PLACE_PARTITION, PLACE_REPLICATE };
+
+// Functions
+
+int placement_policy(const char *name);
+int place_csr(CSR *graph, int policy, int hugepages);
+void *place_state(const CSR *graph, size_t bytes);
+int place_edges(const CSR *graph, size_t width, void *copies[]);
+CSR *local_csr(CSR *graph);
+int numa_nodes();
+int pin_thread(int index);
+
+#endif
@@ -0,0 +1,58 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Readers for networks stored as edge lists or Matrix Market files
+//
+// Function calls:
+//   int read_edgelist(NETWORK *network, FILE *stream, int directed, int nthreads)
+//     -- Reads a whitespace-separated edge list with lines of the form
+//        "source target [weight]", like the test-datasets/*.txt files or
+//        the SNAP collection.  Lines starting with "#" or "%" are
+//        comments.  The vertices are the distinct IDs that appear in the
+//        edges.  "directed" says whether the network is directed, unless
+//        a SNAP header comment ("# Directed graph" or "# Undirected
+//        graph") says otherwise.  Returns 0 if read was successful.
+//   int read_matrixmarket(NETWORK *network, FILE *stream, int nthreads)
+//     -- Reads a Matrix Market coordinate file.  Row and column numbers
+//        are the vertex IDs, from 1 to the matrix size; "symmetric"
+//        matrices give undirected networks and "general" ones directed
+//        networks.  "pattern" matrices are unweighted, "real" and
+//        "integer" ones take the entries as weights.  Returns 0 if read
+//        was successful.
+//
+// Both use up to "nthreads" threads on mapped files (0 means one per
+// online processor), and give the same network whatever that number is.
+
+#ifndef READEDGES_H
+#define READEDGES_H
+
+#include <stdio.h>
+#include "network.h"
+
+int read_edgelist(NETWORK *network, FILE *stream, int directed, int nthreads);
+int read_matrixmarket(NETWORK *network, FILE *stream, int nthreads);
+
+#endif
@@ -0,0 +1,277 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Reading a network in any of the supported input formats.  See
+// "readnet.h".
+
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include "readnet.h"
+#include "loader.h"
+#include "readgml.h"
+#include "readedges.h"
+#include "snapshot.h"
+#include "decoder.h"
+
+#define SNIFFLENGTH 4096
+
+// Types
+
+typedef struct {
+  int index;           // Position of a job in the caller's array
+  double size;         // Size of its file in bytes
+} LOADORDER;
+
+typedef struct {
+  LOADJOB *job;        // Jobs of the batch
+  LOADORDER *order;    // Jobs in the order they are started, largest first
+  int njobs;
+  int next;            // Next entry of order to start
+  int nthreads;        // Threads shared out among the loads
+  double totalsize;    // Sum of the file sizes
+  pthread_mutex_t lock;
+} LOADPOOL;
+
+
+// Function to look up a format name
+
+int network_format(const char *name)
+{
+  if (strcmp(name,"auto")==0) return FORMAT_AUTO;
+  if (strcmp(name,"gml")==0) return FORMAT_GML;
+  if (strcmp(name,"edgelist")==0) return FORMAT_EDGELIST;
+  if (strcmp(name,"snap")==0) return FORMAT_SNAP;
+  if (strcmp(name,"mtx")==0) return FORMAT_MTX;
+  if (strcmp(name,"snapshot")==0) return FORMAT_SNAPSHOT;
+  return -1;
+}
+
+
+// Function to check whether the extension starting at "dot" is "name"
+
+int is_extension(const char *dot, const char *end, const char *name)
+{
+  size_t n = strlen(name);
+  return ((size_t) (end-dot)==n+1)&&(strncasecmp(dot+1,name,n)==0);
+}
+
+
+// Function to guess the format from the extension of a file name, looking
+// past a ".gz" or ".zst" extension.  Returns FORMAT_AUTO if the extension
+// says nothing.
+
+int format_from_name(const char *filename)
+{
+  const char *dot,*end,*p;
+
+  if (filename==NULL) return FORMAT_AUTO;
+  end = filename + strlen(filename);
+  dot = NULL;
+  for (p=filename; p<end; p++) {
+    if (*p=='/') dot = NULL;
+    else if (*p=='.') dot = p;
+  }
+  if (dot==NULL) return FORMAT_AUTO;
+
+  if (is_extension(dot,end,"gz")||is_extension(dot,end,"zst")) {
+    end = dot;
+    for (dot=end-1; (dot>=filename)&&(*dot!='.')&&(*dot!='/'); dot--);
+    if ((dot<filename)||(*dot!='.')) return FORMAT_AUTO;
+  }
+
+  if (is_extension(dot,end,"gml")) return FORMAT_GML;
+  if (is_extension(dot,end,"mtx")) return FORMAT_MTX;
+  if (is_extension(dot,end,"csr")) return FORMAT_SNAPSHOT;
+  if (is_extension(dot,end,"edges")||is_extension(dot,end,"el")||is_extension(dot,end,"tsv"))
+    return FORMAT_EDGELIST;
+  return FORMAT_AUTO;
+}
+
+
+// Function to guess the format from the start of the text.  Comment lines
+// are skipped; a line starting with a letter is taken to be GML and one
+// starting with a number an edge list.  The text is read with pread(), and
+// decompressed first if need be, so the stream is left untouched.  Streams
+// that are not files are taken to be GML.
+
+int format_from_text(FILE *stream)
+{
+  int compression;
+  long offset;
+  ssize_t n;
+  char text[SNIFFLENGTH];
+  const char *p,*end;
+
+  offset = ftell(stream);
+  if (offset<0) return FORMAT_GML;
+  compression = stream_compression(stream);
+  if (compression==COMPRESSION_NONE) n = pread(fileno(stream),text,SNIFFLENGTH,offset);
+  else n = peek_decompressed(stream,compression,text,SNIFFLENGTH);
+  if (n<=0) return FORMAT_GML;
+
+  p = text;
+  end = text + n;
+  if ((n>=14)&&(memcmp(p,"%%MatrixMarket",14)==0)) return FORMAT_MTX;
+
+  while (p<end) {
+    while ((p<end)&&((*p==' ')||(*p=='\t')||(*p=='\r')||(*p=='\n'))) p++;
+    if (p==end) break;
+    if ((*p=='#')||(*p=='%')) {
+      p = (const char*) memchr(p,'\n',end-p);
+      if (p==NULL) break;
+      continue;
+    }
+    if (((*p>='0')&&(*p<='9'))||(*p=='-')||(*p=='+')) return FORMAT_EDGELIST;
+    return FORMAT_GML;
+  }
+
+  return FORMAT_GML;
+}
+
+
+// Function to read a network in a given format
+
+int read_any_network(NETWORK *network, FILE *stream, const char *filename,
+                     int format, int nthreads)
+{
+  if (format==FORMAT_AUTO) {
+    if (is_snapshot(stream)) format = FORMAT_SNAPSHOT;
+    else format = format_from_name(filename);
+    if (format==FORMAT_AUTO) format = format_from_text(stream);
+  }
+
+  switch (format) {
+  case FORMAT_SNAPSHOT: return read_snapshot(network,stream);
+  case FORMAT_EDGELIST: return read_edgelist(network,stream,0,nthreads);
+  case FORMAT_SNAP: return read_edgelist(network,stream,1,nthreads);
+  case FORMAT_MTX: return read_matrixmarket(network,stream,nthreads);
+  default: return read_network_threads(network,stream,nthreads);
+  }
+}
+
+
+// Function to compare two jobs by the size of their files, largest first
+
+int cmpsize(const void *a, const void *b)
+{
+  double x = ((const LOADORDER*) a)->size;
+  double y = ((const LOADORDER*) b)->size;
+
+  if (x>y) return -1;
+  if (x<y) return 1;
+  return ((const LOADORDER*) a)->index - ((const LOADORDER*) b)->index;
+}
+
+
+// Thread function of the loader pool: takes the next job of the batch and
+// reads its file, until there are none left
+
+void *load_jobs(void *arg)
+{
+  LOADPOOL *pool = (LOADPOOL*) arg;
+  LOADJOB *job;
+  FILE *stream;
+  int i,nthreads;
+
+  while (1) {
+    pthread_mutex_lock(&pool->lock);
+    i = pool->next++;
+    pthread_mutex_unlock(&pool->lock);
+    if (i>=pool->njobs) return NULL;
+
+    job = pool->job + pool->order[i].index;
+    nthreads = 1;
+    if (pool->totalsize>0.0) {
+      nthreads = (int) (pool->nthreads*pool->order[i].size/pool->totalsize + 0.5);
+      if (nthreads<1) nthreads = 1;
+    }
+
+    job->result = 1;
+    stream = fopen(job->filename,"rb");
+    if (stream==NULL) continue;
+    job->result = read_any_network(&job->network,stream,job->filename,job->format,nthreads);
+    fclose(stream);
+  }
+}
+
+
+// Function to read the networks of a batch of jobs
+
+int read_networks(LOADJOB job[], int njobs, int nthreads)
+{
+  int i,nworkers;
+  struct stat info;
+  pthread_t *threads;
+  LOADPOOL pool;
+
+  if (njobs<=0) return 0;
+  pool.order = (LOADORDER*) malloc(njobs*sizeof(LOADORDER));
+  if (pool.order==NULL) return 1;
+
+  pool.job = job;
+  pool.njobs = njobs;
+  pool.next = 0;
+  pool.nthreads = thread_count(nthreads);
+  pool.totalsize = 0.0;
+  for (i=0; i<njobs; i++) {
+    job[i].network.nvertices = 0;
+    job[i].network.vertex = NULL;
+    job[i].network.edges = NULL;
+    job[i].network.labels = NULL;
+    job[i].network.label = NULL;
+    pool.order[i].index = i;
+    pool.order[i].size = 0.0;
+    if (stat(job[i].filename,&info)==0) pool.order[i].size = (double) info.st_size;
+    pool.totalsize += pool.order[i].size;
+  }
+  qsort(pool.order,njobs,sizeof(LOADORDER),cmpsize);
+  pthread_mutex_init(&pool.lock,NULL);
+
+  // The calling thread is one of the loaders; if a thread cannot be
+  // started the others take its share of the jobs
+
+  nworkers = (njobs<pool.nthreads) ? njobs : pool.nthreads;
+  threads = (pthread_t*) malloc(nworkers*sizeof(pthread_t));
+  if (threads==NULL) nworkers = 1;
+  for (i=1; i<nworkers; i++) {
+    if (pthread_create(&threads[i],NULL,load_jobs,&pool)!=0) threads[i] = 0;
+  }
+  load_jobs(&pool);
+  for (i=1; i<nworkers; i++) {
+    if (threads[i]!=0) pthread_join(threads[i],NULL);
+  }
+  free(threads);
+  pthread_mutex_destroy(&pool.lock);
+  free(pool.order);
+
+  for (i=0; i<njobs; i++) {
+    if (job[i].result!=0) return 1;
+  }
+  return 0;
+}
@@ -0,0 +1,385 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Relabelling of the vertices of a CSR graph.  See "reorder.h".
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "reorder.h"
+
+#define SHORTLIST 32     // Longest list sorted by insertion
+
+// Types
+
+typedef struct {       // Unit heap: vertices in lists by key, for keys that
+  int *key;            // only ever change by one
+  int *prev;           // Neighbors of each vertex in the list of its key,
+  int *next;           // -1 at the ends
+  int *head;           // First vertex with each key, -1 if none
+  int maxkey;          // Keys that head[] has room for
+  int top;             // No vertex has a larger key than this
+} UNITHEAP;
+
+
+// Function to look up an ordering name
+
+int order_method(const char *name)
+{
+  if (strcmp(name,"none")==0) return ORDER_NONE;
+  if (strcmp(name,"degree")==0) return ORDER_DEGREE;
+  if (strcmp(name,"rcm")==0) return ORDER_RCM;
+  if (strcmp(name,"gorder")==0) return ORDER_GORDER;
+  return -1;
+}
+
+
+// Function to find the degree of a vertex
+
+static inline uint32_t degree_of(const CSR *graph, uint32_t u)
+{
+  return graph->offsets[u+1] - graph->offsets[u];
+}
+
+
+// Function to list the vertices by degree with a counting sort, largest
+// degree first if "descending" is set, otherwise smallest first.  Vertices
+// of the same degree stay in the order of their numbers.  Returns 1 if
+// memory runs out, otherwise 0.
+
+int sort_by_degree(const CSR *graph, uint32_t order[], int descending)
+{
+  uint32_t u,d,maxdegree=0;
+  uint32_t n = (uint32_t) graph->nvertices;
+  uint32_t *count;
+
+  for (u=0; u<n; u++) {
+    if (degree_of(graph,u)>maxdegree) maxdegree = degree_of(graph,u);
+  }
+  count = (uint32_t*) calloc(maxdegree+2,sizeof(uint32_t));
+  if (count==NULL) return 1;
+
+  for (u=0; u<n; u++) {
+    d = degree_of(graph,u);
+    count[(descending ? maxdegree-d : d)+1]++;
+  }
+  for (d=1; d<=maxdegree+1; d++) count[d] += count[d-1];
+  for (u=0; u<n; u++) {
+    d = degree_of(graph,u);
+    order[count[descending ? maxdegree-d : d]++] = u;
+  }
+
+  free(count);
+  return 0;
+}
+
+
+// Function to compare two sort keys
+
+int cmpkey(const void *a, const void *b)
+{
+  uint64_t x = *(const uint64_t*) a;
+  uint64_t y = *(const uint64_t*) b;
+
+  return (x>y) - (x<y);
+}
+
+
+// Function to put the vertices in reverse Cuthill-McKee order.  Each
+// breadth-first search starts from the unvisited vertex of smallest
+// degree, and the neighbors found from a vertex are queued by increasing
+// degree.  Returns 1 if memory runs out, otherwise 0.
+
+int order_rcm(const CSR *graph, uint32_t order[])
+{
+  uint32_t i,j,k,s,u,v,t;
+  uint32_t head,tail,first;
+  uint32_t n = (uint32_t) graph->nvertices;
+  uint32_t *start;
+  uint64_t *found,key;
+  char *visited;
+
+  start = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+  found = (uint64_t*) malloc(((size_t) graph->nedges+1)*sizeof(uint64_t));
+  visited = (char*) calloc(n+1,1);
+  if ((start==NULL)||(found==NULL)||(visited==NULL)||sort_by_degree(graph,start,0)) {
+    free(start);
+    free(found);
+    free(visited);
+    return 1;
+  }
+
+  tail = 0;
+  for (i=0; i<n; i++) {
+    s = start[i];
+    if (visited[s]) continue;
+    visited[s] = 1;
+    order[tail++] = s;
+    for (head=tail-1; head<tail; head++) {
+      u = order[head];
+
+      // Gather the unvisited neighbors, keyed by degree, and sort them.
+      // Short lists, the usual case, are sorted by insertion
+
+      first = 0;
+      for (j=graph->offsets[u]; j<graph->offsets[u+1]; j++) {
+        v = graph->targets[j];
+        if (visited[v]) continue;
+        visited[v] = 1;
+        found[first++] = ((uint64_t) degree_of(graph,v)<<32) | v;
+      }
+      if (first>SHORTLIST) qsort(found,first,sizeof(uint64_t),cmpkey);
+      else {
+        for (j=1; j<first; j++) {
+          key = found[j];
+          for (k=j; (k>0)&&(found[k-1]>key); k--) found[k] = found[k-1];
+          found[k] = key;
+        }
+      }
+      for (k=0; k<first; k++) order[tail++] = (uint32_t) found[k];
+    }
+  }
+
+  // Reverse the order
+
+  for (i=0; i<n/2; i++) {
+    t = order[i];
+    order[i] = order[n-1-i];
+    order[n-1-i] = t;
+  }
+
+  free(start);
+  free(found);
+  free(visited);
+  return 0;
+}
+
+
+// Functions to take a vertex out of the list of its key and to put it
+// into the list of its key again
+
+static inline void heap_remove(UNITHEAP *heap, int v)
+{
+  if (heap->prev[v]>=0) heap->next[heap->prev[v]] = heap->next[v];
+  else heap->head[heap->key[v]] = heap->next[v];
+  if (heap->next[v]>=0) heap->prev[heap->next[v]] = heap->prev[v];
+}
+
+static inline void heap_insert(UNITHEAP *heap, int v)
+{
+  int k = heap->key[v];
+
+  heap->prev[v] = -1;
+  heap->next[v] = heap->head[k];
+  if (heap->head[k]>=0) heap->prev[heap->head[k]] = v;
+  heap->head[k] = v;
+  if (k>heap->top) heap->top = k;
+}
+
+
+// Function to change the key of a vertex that is still in the heap by
+// "change", which is +1 or -1.  Returns 1 if memory runs out.
+
+int heap_change(UNITHEAP *heap, int v, int change)
+{
+  int k;
+  int *head;
+
+  if (heap->key[v]<0) return 0;
+  heap_remove(heap,v);
+  heap->key[v] += change;
+  if (heap->key[v]>=heap->maxkey) {
+    head = (int*) realloc(heap->head,2*heap->maxkey*sizeof(int));
+    if (head==NULL) return 1;
+    for (k=heap->maxkey; k<2*heap->maxkey; k++) head[k] = -1;
+    heap->head = head;
+    heap->maxkey *= 2;
+  }
+  heap_insert(heap,v);
+  return 0;
+}
+
+
+// Function to add "change" to the scores of the vertices still to be
+// placed for vertex u entering or leaving the window: one for each edge
+// between them and u, and one for each neighbor they share with u, except
+// through vertices of degree over "hub".  Returns 1 if memory runs out.
+
+int score_window(const CSR *graph, UNITHEAP *heap, uint32_t u, int change, uint32_t hub)
+{
+  uint32_t j,k,v;
+  int result=0;
+
+  for (j=graph->offsets[u]; j<graph->offsets[u+1]; j++) {
+    v = graph->targets[j];
+    result |= heap_change(heap,v,change);
+    if (degree_of(graph,v)>hub) continue;
+    for (k=graph->offsets[v]; k<graph->offsets[v+1]; k++) {
+      if (graph->targets[k]!=u) result |= heap_change(heap,graph->targets[k],change);
+    }
+  }
+
+  return result;
+}
+
+
+// Function to put the vertices in Gorder order.  Starts from the vertex of
+// largest degree and then keeps taking the vertex with the best score
+// against the window of the last ORDERWINDOW vertices placed.  Returns 1
+// if memory runs out, otherwise 0.
+
+int order_gorder(const CSR *graph, uint32_t order[])
+{
+  int result=0;
+  uint32_t i,u,hub;
+  uint32_t n = (uint32_t) graph->nvertices;
+  UNITHEAP heap;
+
+  if (n==0) return 0;
+  heap.maxkey = 64;
+  heap.top = 0;
+  heap.key = (int*) malloc(n*sizeof(int));
+  heap.prev = (int*) malloc(n*sizeof(int));
+  heap.next = (int*) malloc(n*sizeof(int));
+  heap.head = (int*) malloc(heap.maxkey*sizeof(int));
+  if ((heap.key==NULL)||(heap.prev==NULL)||(heap.next==NULL)||(heap.head==NULL)) result = 1;
+  else {
+    for (i=0; i<(uint32_t) heap.maxkey; i++) heap.head[i] = -1;
+    for (i=n; i>0; i--) {
+      heap.key[i-1] = 0;
+      heap_insert(&heap,i-1);
+    }
+  }
+  hub = (uint32_t) sqrt((double) n) + 1;
+
+  u = 0;
+  for (i=1; i<n; i++) {
+    if (degree_of(graph,i)>degree_of(graph,u)) u = i;
+  }
+
+  for (i=0; (i<n)&&(result==0); i++) {
+
+    // Place u and take it out of the heap, then move the window on
+
+    if (i>0) {
+      while (heap.head[heap.top]<0) heap.top--;
+      u = (uint32_t) heap.head[heap.top];
+    }
+    heap_remove(&heap,u);
+    heap.key[u] = -1;
+    order[i] = u;
+    result |= score_window(graph,&heap,u,1,hub);
+    if (i>=ORDERWINDOW) result |= score_window(graph,&heap,order[i-ORDERWINDOW],-1,hub);
+  }
+
+  free(heap.key);
+  free(heap.prev);
+  free(heap.next);
+  free(heap.head);
+  return result;
+}
+
+
+// Function to relabel a graph
+
+int reorder_csr(CSR *graph, int method, uint32_t **perm)
+{
+  uint32_t i,j,k,u;
+  uint32_t n = (uint32_t) graph->nvertices;
+  size_t width = weight_width(graph->weighttype);
+  uint32_t *order,*offsets,*targets;
+  char *weights=NULL;
+  int result;
+
+  *perm = NULL;
+  if (method==ORDER_NONE) return 0;
+
+  order = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+  if (order==NULL) return 1;
+  switch (method) {
+  case ORDER_DEGREE: result = sort_by_degree(graph,order,1); break;
+  case ORDER_RCM: result = order_rcm(graph,order); break;
+  default: result = order_gorder(graph,order);
+  }
+
+  // Build the relabelled arrays, with the edges of every vertex in the
+  // same order as before
+
+  *perm = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+  offsets = (uint32_t*) malloc((n+1)*sizeof(uint32_t));
+  targets = (uint32_t*) malloc(((size_t) graph->nedges+1)*sizeof(uint32_t));
+  if (width>0) weights = (char*) malloc(((size_t) graph->nedges+1)*width);
+  if (result||(*perm==NULL)||(offsets==NULL)||(targets==NULL)||((width>0)&&(weights==NULL))) {
+    free(order);
+    free(*perm);
+    free(offsets);
+    free(targets);
+    free(weights);
+    *perm = NULL;
+    return 1;
+  }
+
+  for (i=0; i<n; i++) (*perm)[order[i]] = i;
+  k = 0;
+  for (i=0; i<n; i++) {
+    u = order[i];
+    offsets[i] = k;
+    for (j=graph->offsets[u]; j<graph->offsets[u+1]; j++,k++) {
+      targets[k] = (*perm)[graph->targets[j]];
+    }
+    if (width>0) {
+      memcpy(weights+(size_t) offsets[i]*width,(char*) graph->weights+(size_t) graph->offsets[u]*width,
+             (size_t) (k-offsets[i])*width);
+    }
+  }
+  offsets[n] = k;
+
+  free(order);
+  free(graph->offsets);
+  free(graph->targets);
+  free(graph->weights);
+  graph->offsets = offsets;
+  graph->targets = targets;
+  graph->weights = weights;
+  return 0;
+}
+
+
+// Function to put values back into the order of the old vertex numbers
+
+int restore_order(double values[], const uint32_t perm[], int n)
+{
+  int i;
+  double *copy;
+
+  if (perm==NULL) return 0;
+  copy = (double*) malloc((n+1)*sizeof(double));
+  if (copy==NULL) return 1;
+  for (i=0; i<n; i++) copy[i] = values[perm[i]];
+  memcpy(values,copy,n*sizeof(double));
+  free(copy);
+  return 0;
+}
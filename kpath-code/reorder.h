@@ -0,0 +1,79 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Relabelling of the vertices of a CSR graph for cache locality
+//
+// The vertices are numbered in the order of their IDs in the input, which
+// usually has little to do with the structure of the network, so a search
+// or a random walk jumps all over the vertex arrays.  This stage gives the
+// vertices new numbers so that neighbors tend to get nearby numbers:
+//
+//   ORDER_NONE     leave the numbering alone
+//   ORDER_DEGREE   by decreasing degree, so the hubs that most paths go
+//                  through share a few cache lines
+//   ORDER_RCM      reverse Cuthill-McKee: breadth-first from a vertex of
+//                  small degree, neighbors by increasing degree, and the
+//                  whole order reversed
+//   ORDER_GORDER   the window heuristic of Gorder (Wei et al., SIGMOD 2016):
+//                  each next vertex is the one with the most neighbors and
+//                  shared neighbors among the last ORDERWINDOW placed.
+//                  Shared neighbors through vertices of very large degree
+//                  are not counted, which keeps the cost near linear
+//
+// Neighbors are the vertices at the end of the edges of a vertex, so for
+// directed networks only out-edges are followed.  The results of the
+// algorithms on the relabelled graph are put back into the input order
+// with restore_order() before they are printed.
+//
+// Function calls:
+//   int order_method(const char *name)
+//     -- Returns the ORDER_ constant for a name given on the command line
+//        ("none", "degree", "rcm" or "gorder"), or -1 if it is not known
+//   int reorder_csr(CSR *graph, int method, uint32_t **perm)
+//     -- Relabels "graph", which must not be compressed or have its
+//        in-edges built yet, in place.  On success *perm is a new array
+//        with the new number of every vertex, indexed by its old number (NULL
+//        for ORDER_NONE).  Returns 0 if successful, 1 if memory runs out,
+//        in which case the graph is unchanged.
+//   int restore_order(double values[], const uint32_t perm[], int n)
+//     -- Puts n values computed for the relabelled vertices back into the
+//        order of the old numbers.  Returns 0 if successful.
+
+#ifndef REORDER_H
+#define REORDER_H
+
+#include <stdint.h>
+#include "csr.h"
+
+#define ORDERWINDOW 5    // Vertices the Gorder heuristic looks back over
+
+enum { ORDER_NONE, ORDER_DEGREE, ORDER_RCM, ORDER_GORDER };
+
+int order_method(const char *name);
+int reorder_csr(CSR *graph, int method, uint32_t **perm);
+int restore_order(double values[], const uint32_t perm[], int n);
+
+#endif
@@ -0,0 +1,136 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Counter-based random numbers for the samplers
+//
+// The k-path walks and the sources of the randomized betweenness
+// algorithms are drawn from random numbers.  rand() keeps one hidden
+// state behind a lock, gives 31 bits and depends on the order of the
+// calls, so a run could not be repeated and would change with the number
+// of threads.  Here every walk or sample has a stream of its own: the
+// numbers are the Philox4x32-10 cipher of a 64-bit seed (the key) applied
+// to the stream number and the position in the stream (the counter).
+// Each block of the cipher gives 128 random bits, with no state to share
+// or to carry from one walk to the next, so a walk draws the same numbers
+// whichever thread takes it and in whatever order.
+//
+// The stream numbers of the different algorithms are kept apart by the
+// top byte, so the same seed gives independent numbers to each of them.
+// RNG is the generator the algorithms use; any struct with the same
+// members can be put in its place.
+//
+// Members:
+//   RNG random(uint64_t seed, uint64_t stream)
+//     -- Starts the given stream of the given seed
+//   uint64_t next()
+//     -- Returns 64 random bits
+//   uint64_t below(uint64_t n)
+//     -- Returns a number from 0 to n-1, each as likely, for n > 0
+//   double unit()
+//     -- Returns a number from [0,1), in steps of 2^-53
+//
+// Macro:
+//   RNG_STREAM(algorithm,index)
+//     -- The number of stream "index" of one of the RNG_ algorithms
+
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+// Algorithms that draw random numbers
+
+enum { RNG_KPATH = 1, RNG_RAND_BRANDES, RNG_ADAPTIVE_SAMPLING };
+
+#define RNG_STREAM(algorithm,index) (((uint64_t) (algorithm) << 56) | (uint64_t) (index))
+
+struct PHILOX {
+  uint32_t key[2];     // The seed
+  uint32_t counter[4]; // Position in the stream (low words) and stream
+  uint32_t out[4];     // Last block of random bits
+  int left;            // Words of out[] not used yet
+
+  PHILOX(uint64_t seed, uint64_t stream)
+  {
+    key[0] = (uint32_t) seed;
+    key[1] = (uint32_t) (seed >> 32);
+    counter[0] = counter[1] = 0;
+    counter[2] = (uint32_t) stream;
+    counter[3] = (uint32_t) (stream >> 32);
+    left = 0;
+  }
+
+  // Function to encrypt the counter into the next block of random bits
+
+  void block()
+  {
+    uint32_t c0=counter[0],c1=counter[1],c2=counter[2],c3=counter[3];
+    uint32_t k0=key[0],k1=key[1];
+    uint64_t p0,p1;
+    int r;
+
+    for (r=0; r<10; r++) {
+      p0 = (uint64_t) 0xD2511F53u * c0;
+      p1 = (uint64_t) 0xCD9E8D57u * c2;
+      c0 = (uint32_t) (p1 >> 32) ^ c1 ^ k0;
+      c1 = (uint32_t) p1;
+      c2 = (uint32_t) (p0 >> 32) ^ c3 ^ k1;
+      c3 = (uint32_t) p0;
+      k0 += 0x9E3779B9u;
+      k1 += 0xBB67AE85u;
+    }
+    out[0] = c0;
+    out[1] = c1;
+    out[2] = c2;
+    out[3] = c3;
+    left = 4;
+    if (++counter[0]==0) counter[1]++;
+  }
+
+  uint64_t next()
+  {
+    if (left==0) block();
+    left -= 2;
+    return ((uint64_t) out[left+1] << 32) | out[left];
+  }
+
+  // A number below n, from the top 64 bits of the 128-bit product of n
+  // and 64 random bits.  The bias is at most n/2^64.
+
+  uint64_t below(uint64_t n)
+  {
+    return (uint64_t) (((unsigned __int128) next() * n) >> 64);
+  }
+
+  double unit()
+  {
+    return (double) (next() >> 11) * (1.0/9007199254740992.0);
+  }
+};
+
+typedef PHILOX RNG;
+
+#endif
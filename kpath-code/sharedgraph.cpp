@@ -0,0 +1,388 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Graphs shared between processes.  See "sharedgraph.h".
+
+#include <stdlib.h>
+#include <string.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/vfs.h>
+#include "sharedgraph.h"
+
+#define HUGETLBFS_MAGIC 0x958458f6
+
+
+// Function to round a length up to a multiple of 8
+
+static size_t aligned(size_t length)
+{
+  return (length + 7)&~(size_t) 7;
+}
+
+
+// Function to tell whether a name is a POSIX shared memory object rather
+// than a path
+
+int is_shm_name(const char *name)
+{
+  return (name[0]=='/')&&(strchr(name+1,'/')==NULL);
+}
+
+
+// Function to open a segment, creating it anew if "create" is set.  Any
+// segment of the same name is removed first, so that processes attached
+// to it keep the old graph intact.  Returns a file descriptor, -1 on error.
+
+int open_segment(const char *name, int create)
+{
+  if (is_shm_name(name)) {
+    if (!create) return shm_open(name,O_RDONLY,0);
+    shm_unlink(name);
+    return shm_open(name,O_RDWR|O_CREAT|O_EXCL,0644);
+  }
+
+  if (!create) return open(name,O_RDONLY);
+  unlink(name);
+  return open(name,O_RDWR|O_CREAT|O_EXCL,0644);
+}
+
+
+// Function to remove a segment again after a failed publication
+
+void remove_segment(const char *name)
+{
+  if (is_shm_name(name)) shm_unlink(name);
+  else unlink(name);
+}
+
+
+// Function to find the sizes of the sections that hold the arrays of a
+// graph, from section "first" on, and the arrays that go in them
+
+void graph_sections(const CSR *graph, int first, size_t size[], const void *source[])
+{
+  uint64_t n = graph->nvertices;
+  uint64_t m = graph->nedges;
+
+  size[first+SECTION_OFFSETS] = (n+1)*sizeof(uint32_t);
+  if (graph->targets!=NULL) size[first+SECTION_TARGETS] = m*sizeof(uint32_t);
+  if (graph->weights!=NULL) size[first+SECTION_WEIGHTS] = m*weight_width(graph->weighttype);
+  if (graph->packed!=NULL) {
+    size[first+SECTION_PACKED] = graph->packedoffsets[n];
+    size[first+SECTION_PACKEDOFFSETS] = (n+1)*sizeof(uint64_t);
+  }
+  source[first+SECTION_OFFSETS] = graph->offsets;
+  source[first+SECTION_TARGETS] = graph->targets;
+  source[first+SECTION_WEIGHTS] = graph->weights;
+  source[first+SECTION_PACKED] = graph->packed;
+  source[first+SECTION_PACKEDOFFSETS] = graph->packedoffsets;
+}
+
+
+// Function to find the sizes the sections of the arrays of a graph must
+// have, from section "first" on, going by the header
+
+void expected_sections(const SHARED_HEADER *header, int first, uint64_t packedlength, size_t size[])
+{
+  uint64_t n = header->nvertices;
+  uint64_t m = header->nentries;
+
+  size[first+SECTION_OFFSETS] = (n+1)*sizeof(uint32_t);
+  if (!(header->flags&SHARED_PACKED)) size[first+SECTION_TARGETS] = m*sizeof(uint32_t);
+  else {
+    size[first+SECTION_PACKED] = packedlength;
+    size[first+SECTION_PACKEDOFFSETS] = (n+1)*sizeof(uint64_t);
+  }
+  size[first+SECTION_WEIGHTS] = m*weight_width(header->weighttype);
+}
+
+
+// Function to point the arrays of a graph at their sections in the
+// mapping, from section "first" on
+
+void point_graph(CSR *graph, char *base, const SHARED_HEADER *header, int first)
+{
+  int packed = (header->flags&SHARED_PACKED) ? 1 : 0;
+
+  graph->offsets = (uint32_t*) (base + header->section[first+SECTION_OFFSETS]);
+  graph->targets = packed ? NULL : (uint32_t*) (base + header->section[first+SECTION_TARGETS]);
+  graph->weights = (weight_width(header->weighttype)>0) ? base + header->section[first+SECTION_WEIGHTS] : NULL;
+  graph->packed = packed ? (unsigned char*) base + header->section[first+SECTION_PACKED] : NULL;
+  graph->packedoffsets = packed ? (uint64_t*) (base + header->section[first+SECTION_PACKEDOFFSETS]) : NULL;
+}
+
+
+// Function to publish a graph
+
+int publish_graph(const char *name, NETWORK *network, CSR *graph,
+                  const uint32_t perm[], int hugepages)
+{
+  int fd,a;
+  uint64_t i,n,m,end;
+  size_t size[NSECTIONS],length,pagesize;
+  char *base;
+  const void *source[NSECTIONS];
+  int64_t *ids,*labels;
+  SHARED_HEADER header;
+  struct statfs fs;
+
+  n = graph->nvertices;
+  m = graph->nedges;
+
+  // Work out the sections
+
+  memset(&header,0,sizeof(header));
+  header.version = SHARED_VERSION;
+  header.byteorder = SHARED_BYTEORDER;
+  header.flags = (graph->directed ? SHARED_DIRECTED : 0)
+    | ((graph->packed!=NULL) ? SHARED_PACKED : 0)
+    | ((perm!=NULL) ? SHARED_PERMUTED : 0)
+    | ((network->label!=NULL) ? SHARED_LABELED : 0)
+    | ((graph->reverse!=NULL) ? SHARED_REVERSED : 0);
+  header.weighttype = graph->weighttype;
+  header.nvertices = n;
+  header.nedges = network->nedges;
+  header.nentries = m;
+  header.packedlength = (graph->packed!=NULL) ? graph->packedoffsets[n] : 0;
+  if ((graph->reverse!=NULL)&&(graph->reverse->packed!=NULL))
+    header.rpackedlength = graph->reverse->packedoffsets[n];
+  header.weight = graph->weight;
+  header.max_weight = graph->max_weight;
+  header.max_network = network->MAX_Weight;
+  header.min_network = network->MIN_Weight;
+  if (network->label!=NULL) {
+    for (i=0; i<n; i++) {
+      if (network->label[i]<0) continue;
+      end = network->label[i] + strlen(network->labels + network->label[i]) + 1;
+      if (end>header.textlength) header.textlength = end;
+    }
+  }
+
+  memset(size,0,sizeof(size));
+  memset(source,0,sizeof(source));
+  graph_sections(graph,0,size,source);
+  if (graph->reverse!=NULL) graph_sections(graph->reverse,SECTION_REVERSE,size,source);
+  if (perm!=NULL) size[SECTION_PERM] = n*sizeof(uint32_t);
+  size[SECTION_IDS] = n*sizeof(int64_t);
+  if (network->label!=NULL) {
+    size[SECTION_LABELS] = n*sizeof(int64_t);
+    size[SECTION_TEXT] = header.textlength;
+  }
+
+  length = aligned(sizeof(SHARED_HEADER));
+  for (a=0; a<NSECTIONS; a++) {
+    if (size[a]==0) continue;
+    header.section[a] = length;
+    length += aligned(size[a]);
+  }
+  header.length = length;
+
+  // Make the segment.  Files on hugetlbfs must be a whole number of huge
+  // pages long.
+
+  fd = open_segment(name,1);
+  if (fd<0) return 1;
+  pagesize = 1;
+  if ((fstatfs(fd,&fs)==0)&&(fs.f_type==HUGETLBFS_MAGIC)) pagesize = fs.f_bsize;
+  length = (length + pagesize - 1)/pagesize*pagesize;
+  if (ftruncate(fd,length)!=0) {
+    close(fd);
+    remove_segment(name);
+    return 1;
+  }
+  base = (char*) mmap(NULL,length,PROT_READ|PROT_WRITE,MAP_SHARED,fd,0);
+  close(fd);
+  if (base==MAP_FAILED) {
+    remove_segment(name);
+    return 1;
+  }
+  if (hugepages) madvise(base,length,MADV_HUGEPAGE);
+
+  // Fill it in, header last
+
+  source[SECTION_PERM] = perm;
+  source[SECTION_TEXT] = network->labels;
+  for (a=0; a<NSECTIONS; a++) {
+    if ((size[a]==0)||(a==SECTION_IDS)||(a==SECTION_LABELS)) continue;
+    memcpy(base + header.section[a],source[a],size[a]);
+  }
+  ids = (int64_t*) (base + header.section[SECTION_IDS]);
+  for (i=0; i<n; i++) ids[i] = network->vertex[i].id;
+  if (network->label!=NULL) {
+    labels = (int64_t*) (base + header.section[SECTION_LABELS]);
+    for (i=0; i<n; i++) labels[i] = network->label[i];
+  }
+
+  memcpy(base,&header,sizeof(header));
+  __atomic_thread_fence(__ATOMIC_RELEASE);
+  memcpy(base,SHARED_MAGIC,8);
+  munmap(base,length);
+
+  return 0;
+}
+
+
+// Function to attach to a published graph
+
+int attach_graph(const char *name, NETWORK *network, CSR *graph, uint32_t **perm)
+{
+  int fd,a,valid;
+  uint64_t i,n,m;
+  CSR *reverse=NULL;
+  size_t size[NSECTIONS];
+  char *base;
+  const uint32_t *offsets;
+  const int64_t *ids,*labels;
+  SHARED_HEADER header;
+  struct stat info;
+
+  network->nvertices = 0;
+  network->vertex = NULL;
+  network->edges = NULL;
+  network->labels = NULL;
+  network->label = NULL;
+  *perm = NULL;
+
+  // Map the segment and check the header
+
+  fd = open_segment(name,0);
+  if (fd<0) return 1;
+  if ((fstat(fd,&info)!=0)||((size_t) info.st_size<sizeof(SHARED_HEADER))) {
+    close(fd);
+    return 1;
+  }
+  base = (char*) mmap(NULL,info.st_size,PROT_READ,MAP_SHARED,fd,0);
+  close(fd);
+  if (base==MAP_FAILED) return 1;
+
+  memcpy(&header,base,sizeof(header));
+  __atomic_thread_fence(__ATOMIC_ACQUIRE);
+  n = header.nvertices;
+  m = header.nentries;
+  valid = (memcmp(header.magic,SHARED_MAGIC,8)==0)&&(header.version==SHARED_VERSION)
+    &&(header.byteorder==SHARED_BYTEORDER)&&(header.length<=(uint64_t) info.st_size)
+    &&(n<INT32_MAX)&&(m<UINT32_MAX);
+
+  memset(size,0,sizeof(size));
+  expected_sections(&header,0,header.packedlength,size);
+  if (header.flags&SHARED_REVERSED) expected_sections(&header,SECTION_REVERSE,header.rpackedlength,size);
+  if (header.flags&SHARED_PERMUTED) size[SECTION_PERM] = n*sizeof(uint32_t);
+  size[SECTION_IDS] = n*sizeof(int64_t);
+  if (header.flags&SHARED_LABELED) {
+    size[SECTION_LABELS] = n*sizeof(int64_t);
+    size[SECTION_TEXT] = header.textlength;
+  }
+  for (a=0; valid&&(a<NSECTIONS); a++) {
+    if (size[a]==0) continue;
+    if ((header.section[a]==0)||(header.section[a]%8!=0)||(header.section[a]>header.length)
+        ||(size[a]>header.length-header.section[a])) valid = 0;
+  }
+  if (valid) {
+    offsets = (const uint32_t*) (base + header.section[SECTION_OFFSETS]);
+    if (offsets[n]!=m) valid = 0;
+  }
+  if (valid&&(header.flags&SHARED_REVERSED)) {
+    if (((const uint32_t*) (base + header.section[SECTION_REVERSE+SECTION_OFFSETS]))[n]!=m) valid = 0;
+  }
+  if (!valid) {
+    munmap(base,info.st_size);
+    return 1;
+  }
+
+  // The network gets the vertices but not the edges, which only the CSR
+  // graph has
+
+  network->vertex = (VERTEX*) calloc(n>0 ? n : 1,sizeof(VERTEX));
+  if (header.flags&SHARED_LABELED) {
+    network->label = (long*) malloc((n>0 ? n : 1)*sizeof(long));
+    network->labels = (char*) malloc(header.textlength>0 ? header.textlength : 1);
+  }
+  if (header.flags&SHARED_PERMUTED) *perm = (uint32_t*) malloc((n>0 ? n : 1)*sizeof(uint32_t));
+  if (header.flags&SHARED_REVERSED) reverse = (CSR*) malloc(sizeof(CSR));
+  if ((network->vertex==NULL)||((header.flags&SHARED_PERMUTED)&&(*perm==NULL))
+      ||((header.flags&SHARED_LABELED)&&((network->label==NULL)||(network->labels==NULL)))
+      ||((header.flags&SHARED_REVERSED)&&(reverse==NULL))) {
+    free(reverse);
+    free(network->vertex);
+    free(network->label);
+    free(network->labels);
+    free(*perm);
+    network->vertex = NULL;
+    network->label = NULL;
+    network->labels = NULL;
+    *perm = NULL;
+    munmap(base,info.st_size);
+    return 1;
+  }
+
+  ids = (const int64_t*) (base + header.section[SECTION_IDS]);
+  for (i=0; i<n; i++) {
+    network->vertex[i].id = ids[i];
+    network->vertex[i].degree = (int) (offsets[i+1] - offsets[i]);
+    network->vertex[i].edge = NULL;
+  }
+  if (header.flags&SHARED_LABELED) {
+    labels = (const int64_t*) (base + header.section[SECTION_LABELS]);
+    for (i=0; i<n; i++) network->label[i] = (labels[i]<(int64_t) header.textlength) ? (long) labels[i] : -1;
+    memcpy(network->labels,base + header.section[SECTION_TEXT],header.textlength);
+    if (header.textlength>0) network->labels[header.textlength-1] = '\0';
+  }
+  if (*perm!=NULL) memcpy(*perm,base + header.section[SECTION_PERM],n*sizeof(uint32_t));
+  network->nvertices = (int) n;
+  network->nedges = (int) header.nedges;
+  network->directed = (header.flags&SHARED_DIRECTED) ? 1 : 0;
+  network->MAX_Weight = header.max_network;
+  network->MIN_Weight = header.min_network;
+
+  // The graph and its in-edges point into the mapping, which belongs to
+  // the graph
+
+  graph->nvertices = (int) n;
+  graph->nedges = (int) m;
+  graph->directed = network->directed;
+  graph->weighttype = header.weighttype;
+  graph->weight = header.weight;
+  graph->max_weight = header.max_weight;
+  point_graph(graph,base,&header,0);
+  graph->replicas = NULL;
+  graph->nreplicas = 0;
+  graph->mapping = base;
+  graph->mappinglength = info.st_size;
+  graph->reverse = NULL;
+  graph->placement = 0;
+  graph->hugepages = 0;
+  if (reverse!=NULL) {
+    *reverse = *graph;
+    point_graph(reverse,base,&header,SECTION_REVERSE);
+    reverse->mappinglength = 0;
+    graph->reverse = reverse;
+  }
+
+  return 0;
+}
@@ -0,0 +1,77 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Removal of duplicate edges and self-loops from a network
+//
+// The readers keep every edge of the input, so an edge given twice is
+// followed twice by the algorithms and a self-loop adds to the degree of its
+// vertex.  This stage cleans the compressed sparse row edge block of a
+// network after it is read, following a policy for each:
+//
+//   duplicates   DUPLICATES_KEEP   leave repeated edges alone
+//                DUPLICATES_DROP   keep the first of the repeated edges
+//                DUPLICATES_SUM    keep the first, with the sum of the
+//                                  weights of all of them
+//   self-loops   SELFLOOPS_KEEP    leave them alone
+//                SELFLOOPS_DROP    remove them
+//
+// The edges that remain keep their order.  In an undirected network an
+// edge is repeated whichever way round its endpoints are given.  Vertices
+// are handled in parallel, each thread with its own small hash table of the
+// neighbors already seen, sized to the largest degree among its vertices.
+//
+// Function calls:
+//   int simplify_network(NETWORK *network, int duplicates, int selfloops,
+//                        int nthreads, SIMPLIFY_REPORT *report)
+//     -- Applies the policies to "network" using up to "nthreads" threads
+//        (0 means one per online processor) and counts the edges removed
+//        in "report".  The network must have a single edge block, as the
+//        readers and read_snapshot() give.  Returns 0 if successful, 1 if
+//        memory runs out.
+//   int duplicates_policy(const char *name)
+//   int selfloops_policy(const char *name)
+//     -- Return the policy for a name given on the command line ("keep",
+//        "drop" or "sum"), or -1 if the name is not known
+
+#ifndef SIMPLIFY_H
+#define SIMPLIFY_H
+
+#include "network.h"
+
+enum { DUPLICATES_KEEP, DUPLICATES_DROP, DUPLICATES_SUM };
+enum { SELFLOOPS_KEEP, SELFLOOPS_DROP };
+
+typedef struct {
+  long selfloops;      // Self-loops removed
+  long duplicates;     // Repeated edges removed or merged into the first
+} SIMPLIFY_REPORT;
+
+int simplify_network(NETWORK *network, int duplicates, int selfloops,
+                     int nthreads, SIMPLIFY_REPORT *report);
+int duplicates_policy(const char *name);
+int selfloops_policy(const char *name);
+
+#endif
@@ -0,0 +1,92 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Binary snapshots of a network
+//
+// A snapshot holds a network in compressed sparse row (CSR) form, so that
+// it can be loaded again without any parsing.  The file layout is
+//
+//   SNAPSHOT_HEADER     fixed-size header, see below
+//   offsets             (nvertices+1) x uint64: the edges of vertex i are
+//                       entries offsets[i] .. offsets[i+1]-1
+//   targets             nentries x uint32: vertex index of each neighbor
+//   weights             nentries x double, only if SNAPSHOT_WEIGHTED
+//   ids                 nvertices x int64: GML ID of each vertex
+//   labels              only if SNAPSHOT_LABELED: nvertices x int64 offset
+//                       of each vertex's label in the text (-1 if none),
+//                       then the uint64 length of the text and the text,
+//                       a series of NUL-terminated strings
+//
+// Every section starts on an 8-byte boundary.  Numbers are stored in the
+// byte order of the machine that wrote the file; the header records it so
+// that a snapshot from a machine of the other byte order is rejected.
+//
+// Function calls:
+//   int write_snapshot(NETWORK *network, FILE *stream)
+//     -- Writes "network" to "stream".  Returns 0 if successful.
+//   int is_snapshot(FILE *stream)
+//     -- Returns 1 if the file behind "stream" starts with a snapshot
+//        header, otherwise 0.  The stream position is not changed.
+//   int read_snapshot(NETWORK *network, FILE *stream)
+//     -- Maps the snapshot behind "stream" into memory and builds
+//        "network" from it.  Returns 0 if successful.  The network is
+//        freed with free_network() as usual.
+
+#ifndef SNAPSHOT_H
+#define SNAPSHOT_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include "network.h"
+
+#define SNAPSHOT_MAGIC "KPATHCSR"
+#define SNAPSHOT_VERSION 1
+#define SNAPSHOT_BYTEORDER 0x01020304
+
+// Flags
+
+#define SNAPSHOT_DIRECTED 1      // Network is directed
+#define SNAPSHOT_WEIGHTED 2      // File has a weights section
+#define SNAPSHOT_LABELED 4       // File has a labels section
+
+typedef struct {
+  char magic[8];         // SNAPSHOT_MAGIC, not NUL-terminated
+  uint32_t version;      // SNAPSHOT_VERSION
+  uint32_t byteorder;    // SNAPSHOT_BYTEORDER as written by the writer
+  uint32_t flags;        // SNAPSHOT_ flags
+  uint32_t targetwidth;  // Bytes per entry of the targets section
+  uint64_t nvertices;    // Number of vertices
+  uint64_t nedges;       // Number of edges, as in NETWORK
+  uint64_t nentries;     // Number of adjacency entries (sum of degrees)
+  double max_weight;     // MAX_Weight and MIN_Weight of the network
+  double min_weight;
+} SNAPSHOT_HEADER;
+
+int write_snapshot(NETWORK *network, FILE *stream);
+int is_snapshot(FILE *stream);
+int read_snapshot(NETWORK *network, FILE *stream);
+
+#endif
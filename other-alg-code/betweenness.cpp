@@ -27,21 +27,150 @@ THE SOFTWARE.
 #include "betweenness.h"
 
 /* 
- * Brandes Algorithm for weighted graphs
+ * Shortest paths from vertex i in a graph with whole-number weights of at least 1, found with a 
+ * bucket queue instead of a heap. The vertices at distance b wait in Bucket[b % Bucket.size()]; 
+ * as no weight is larger than Bucket.size()-1, the buckets can be used again in turn. Fills in 
+ * d, sigma and S the way the heap search of the weighted algorithms does. 
  */ 
-void BrandesAlgorithm_Weighted(f64 CB[], NETWORK *network, f64 &time_dif) { 
+template <class W> 
+void BucketSearch(CSR *graph, const W weights[], ui64 i, vector<ui64> &d, vector<ui64> &sigma, 
+		vector< vector <uint32_t> > &Bucket, stack <uint32_t> &S) { 
+	
+	ui64 b, j, k, u, v, v_distance; 
+	ui64 nbuckets = (ui64) Bucket.size(); 
+	ui64 pending;								// The number of entries in the buckets 
+	
+	d[i] = 0; 
+	sigma[i] = 1; 
+	Bucket[0].push_back(i); 
+	pending = 1; 
+	
+	// Settle the vertices in order of their distance, one bucket at a time 
+	for (b=0; pending != 0; b++) {
+		vector <uint32_t> &B = Bucket[b % nbuckets]; 
+		for (k=0; k < B.size(); k++) {
+			u = B[k]; 
+			// Skip the entries left behind when the distance of u went down 
+			if (d[u] != b) 
+				continue; 
+			// Push u onto the stack S. Needed later for betweenness computation
+			S.push(u); 
+			// Iterate over all the neighbors of u 
+			for (j=graph->offsets[u]; j < (ui64) graph->offsets[u+1]; j++) { 
+				// Get the neighbor v of vertex u and its distance through u 
+				v = (ui64) graph->targets[j]; 
+				v_distance = b + (ui64) weights[j]; 
+				
+				/* Relax and Count */ 
+				if (v_distance < d[v]) {
+					d[v] = v_distance; 
+					sigma[v] = sigma[u]; 
+					Bucket[v_distance % nbuckets].push_back(v); 
+					pending++; 
+				}
+				else if (v_distance == d[v]) {
+					sigma[v] += sigma[u]; 
+				}
+			} // End For 
+		}
+		pending -= B.size(); 
+		B.clear(); 
+	}
+	
+	return; 
+}
+
+/* 
+ * Shortest paths from vertex i in an unweighted graph, found one level at a time. A level is normally 
+ * found top-down, following the edges out of the level before. When those are more than the edges 
+ * into the vertices not reached yet, it is found bottom-up instead: every vertex not reached yet adds 
+ * up the paths of its in-neighbors on the level before. Fills in d, sigma and S, which gets the 
+ * vertices level after level, i first. 
+ */ 
+template <class NEIGHBORS> 
+void BreadthFirstSearch(CSR *graph, CSR *reverse, ui64 i, vector<uint32_t> &d, vector<ui64> &sigma, vector<uint32_t> &S) { 
+	
+	ui64 k, u, v, level, first, last; 
+	uint32_t t;									// A neighbor read from a neighbor list 
+	const uint32_t UNREACHED = numeric_limits<uint32_t>::max();	// Distance of the vertices not reached yet
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
+	ui64 frontier_edges;						// The edges out of the last level found 
+	ui64 unreached_edges;						// The edges into the vertices not reached yet 
+	
+	d[i] = 0; 
+	sigma[i] = 1; 
+	S.push_back(i); 
+	frontier_edges = graph->offsets[i+1] - graph->offsets[i]; 
+	unreached_edges = (ui64) graph->nedges - (reverse->offsets[i+1] - reverse->offsets[i]); 
+	
+	for (level=0, first=0; first < S.size(); level++, first=last) {
+		last = S.size(); 
+		
+		if (frontier_edges > unreached_edges + nvertices/BOTTOMUP_SCAN) {
+			// Bottom-up: look for the vertices whose in-neighbors include the last level 
+			for (v=0; v < nvertices; v++) {
+				if (d[v] != UNREACHED) 
+					continue; 
+				NEIGHBORS in(reverse, (uint32_t) v); 
+				while (in.next(t)) { 
+					if (d[t] == level) 
+						sigma[v] += sigma[t]; 
+				}
+				if (sigma[v] != 0) {
+					d[v] = level + 1; 
+					S.push_back(v); 
+				}
+			}
+		}
+		else {
+			// Top-down: follow the edges out of the last level 
+			for (k=first; k < last; k++) {
+				u = S[k]; 
+				NEIGHBORS it(graph, (uint32_t) u); 
+				while (it.next(t)) { 
+					v = (ui64) t; 
+					
+					/* Relax and Count */
+					if (d[v] == UNREACHED) { 
+						d[v] = level + 1; 
+						S.push_back(v); 
+					} 
+					if (d[v] == level + 1) 
+						sigma[v] += sigma[u]; 
+				}
+			}
+		}
+		
+		// Count the edges the next level would follow either way 
+		frontier_edges = 0; 
+		for (k=last; k < S.size(); k++) {
+			v = S[k]; 
+			frontier_edges += graph->offsets[v+1] - graph->offsets[v]; 
+			unreached_edges -= reverse->offsets[v+1] - reverse->offsets[v]; 
+		}
+	}
+	
+	return; 
+}
+
+/* 
+ * Brandes Algorithm for weighted graphs, with a heap
+ */ 
+template <class W> 
+void BrandesAlgorithm_Weighted(f64 CB[], CSR *graph, const COMPONENTS *components, const W weights[], f64 &time_dif) { 
 	
 	ui64 i, j, u, v;
-	ui64 nvertices = (ui64) network->nvertices;	// The number of vertices in the network
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
 	f64 u_distance, v_distance, edgeWeight;		// Variables to store distance estimates or edge weights
 	
 	time_t start, end;							// Time variables
 	
 	vector<ui64> sigma;							// sigma is the number of shortest paths
 	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
-	vector< vector <ui64> > PredList;			// A list of predecessors of all vertices 
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
+	const W *reverseWeights = (const W *) reverse->weights;	// The weights of the in-edges
 	
-	stack <ui64> S;								// A stack containing vertices in the order found by Dijkstra's Algorithm
+	stack <uint32_t> S;							// A stack containing vertices in the order found by Dijkstra's Algorithm
 	
 	FibHeap PQueue;								// A priority queue storing vertices
 	FibHeapNode nodeTemp;						// A particular node stored in the priority queue
@@ -50,6 +179,12 @@ void BrandesAlgorithm_Weighted(f64 CB[], NETWORK *network, f64 &time_dif) {
 	
 	// Set the start time of Brandes' Algorithm
 	time(&start); 
+	
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(CB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
 
 	nodeVector.assign ( nvertices, NULL );
 	for (i=0; i < nvertices; i++) {
@@ -62,8 +197,11 @@ void BrandesAlgorithm_Weighted(f64 CB[], NETWORK *network, f64 &time_dif) {
 	// Compute Betweenness Centrality for every vertex i
 	for (i=0; i < nvertices; i++) {
 		
+		// Trivial components were done above 
+		if (trivial_vertex(components, i)) 
+			continue; 
+		
 		/* Initialize */ 
-		PredList.assign(nvertices, vector <ui64> (0, 0)); 
 		sigma.assign(nvertices, 0); 
 		sigma[i] = 1; 
 		delta.assign(nvertices, 0); 
@@ -82,11 +220,11 @@ void BrandesAlgorithm_Weighted(f64 CB[], NETWORK *network, f64 &time_dif) {
 			// Shortest path distance from source i to vertex u
 			u_distance = nodeVector[u]->Get_key(); 
 			// Iterate over all the neighbors of u 
-			for (j=0; j < (ui64) network->vertex[u].degree; j++) { 
+			for (j=graph->offsets[u]; j < (ui64) graph->offsets[u+1]; j++) { 
 				// Get the neighbor v of vertex u
-				v = (ui64) network->vertex[u].edge[j].target; 
+				v = (ui64) graph->targets[j]; 
 				// Get the weight of the edge (u,v) 
-				edgeWeight = (f64) network->vertex[u].edge[j].weight; 
+				edgeWeight = (f64) weights[j]; 
 				// If v's shortest path distance estimate has not been set yet, then 
 				// set the distance estimate of v and store v in the priority queue
 				if (nodeVector[v]->Get_key() == ULONG_MAX) {
@@ -99,12 +237,9 @@ void BrandesAlgorithm_Weighted(f64 CB[], NETWORK *network, f64 &time_dif) {
 				/* Relax and Count */ 
 				if (v_distance == u_distance + edgeWeight) { 
 					sigma[v] += sigma[u]; 
-					PredList[v].push_back(u); 
 				}
 				if (v_distance > u_distance + edgeWeight) {
 					sigma[v] = sigma[u]; 
-					PredList[v].clear(); 
-					PredList[v].push_back(u); 
 					nodeTemp.Set_vertexPosition(v); 
 					nodeTemp.Set_key(u_distance + edgeWeight); 
 					if (PQueue.DecreaseKey(nodeVector[v], nodeTemp) != 0) 
@@ -120,15 +255,17 @@ void BrandesAlgorithm_Weighted(f64 CB[], NETWORK *network, f64 &time_dif) {
 		while (!S.empty()) { 
 			u = S.top(); 
 			S.pop(); 
-			for (j=0; j < PredList[u].size(); j++) {
-				delta[PredList[u][j]] += ((f64) sigma[PredList[u][j]]/sigma[u]) * (1+delta[u]); 
+			// Look the predecessors of u up among its in-neighbors: those a shortest path to u comes through 
+			for (j=reverse->offsets[u]; j < (ui64) reverse->offsets[u+1]; j++) { 
+				v = (ui64) reverse->targets[j]; 
+				if (nodeVector[v]->Get_key() + (f64) reverseWeights[j] == nodeVector[u]->Get_key()) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
 			}
 			if (u != i) 
 				CB[u] += delta[u]; 
 		}
 		
 		// Clear data for the next run
-		PredList.clear(); 
 		sigma.clear(); 
 		delta.clear(); 
 		for (j=0; j < nvertices; j++) 
@@ -149,76 +286,148 @@ void BrandesAlgorithm_Weighted(f64 CB[], NETWORK *network, f64 &time_dif) {
 } // End of BrandesAlgorithm_Weighted 
 
 /* 
- * Brandes Algorithm for unweighted graphs
+ * Brandes Algorithm for graphs with small whole-number weights, with a bucket queue
  */ 
-void BrandesAlgorithm_Unweighted(f64 CB[], NETWORK *network, f64 &time_dif) { 
+template <class W> 
+void BrandesAlgorithm_Buckets(f64 CB[], CSR *graph, const COMPONENTS *components, const W weights[], f64 &time_dif) { 
 	
 	ui64 i, j, u, v;
-	ui64 nvertices = (ui64) network->nvertices;	// The number of vertices in the network
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
 	
 	time_t start, end;							// Time variables
 	
-	vector<ui64> d;								// A vector storing shortest distance estimates
+	vector<ui64> d;								// A vector storing shortest distances
 	vector<ui64> sigma;							// sigma is the number of shortest paths
 	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
-	vector< vector <ui64> > PredList;			// A list of predecessors of all vertices 
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
+	const W *reverseWeights = (const W *) reverse->weights;	// The weights of the in-edges
+	
+	stack <uint32_t> S;							// A stack containing vertices in the order found by Dijkstra's Algorithm
 	
-	queue <ui64> Q;								// A priority queue soring vertices
-	stack <ui64> S;								// A stack containing vertices in the order found by Dijkstra's Algorithm
+	vector< vector <uint32_t> > Bucket;		// The bucket queue of the vertices waiting to be settled
 	
 	// Set the start time of Brandes' Algorithm
 	time(&start); 
 	
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(CB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
+
+	// One bucket for each distance from 0 to the largest weight
+	Bucket.assign((ui64) graph->max_weight + 1, vector <uint32_t> ()); 
+	
 	// Compute Betweenness Centrality for every vertex i
 	for (i=0; i < nvertices; i++) {
 		
+		// Trivial components were done above 
+		if (trivial_vertex(components, i)) 
+			continue; 
+		
 		/* Initialize */ 
-		PredList.assign(nvertices, vector <ui64> (0, 0)); 
 		d.assign(nvertices, ULONG_MAX); 
-		d[i] = 0; 
 		sigma.assign(nvertices, 0); 
 		sigma[i] = 1; 
 		delta.assign(nvertices, 0); 
-		Q.push(i); 
 		
-		// Use Breadth First Search algorithm 
-		while (!Q.empty()) {
-			// Get the next element in the queue
-			u = Q.front(); 
-			Q.pop(); 
-			// Push u onto the stack S. Needed later for betweenness computation
-			S.push(u); 
-			// Iterate over all the neighbors of u 
-			for (j=0; j < (ui64) network->vertex[u].degree; j++) { 
-				// Get the neighbor v of vertex u
-				v = (ui64) network->vertex[u].edge[j].target; 
-				
-				/* Relax and Count */
-				if (d[v] == ULONG_MAX) { 
-					 d[v] = d[u] + 1; 
-					 Q.push(v); 
-				} 
-				if (d[v] == d[u] + 1) {
-					sigma[v] += sigma[u]; 
-					PredList[v].push_back(u); 
-				}
-			} // End For
-			
-		} // End While 
+		// Find the shortest paths from i 
+		BucketSearch(graph, weights, i, d, sigma, Bucket, S); 
 					
+
 		/* Accumulation */ 
 		while (!S.empty()) { 
 			u = S.top(); 
 			S.pop(); 
-			for (j=0; j < PredList[u].size(); j++) {
-				delta[PredList[u][j]] += ((f64) sigma[PredList[u][j]]/sigma[u]) * (1+delta[u]); 
+			// Look the predecessors of u up among its in-neighbors: those a shortest path to u comes through 
+			for (j=reverse->offsets[u]; j < (ui64) reverse->offsets[u+1]; j++) { 
+				v = (ui64) reverse->targets[j]; 
+				if ((d[v] < d[u]) && (d[u] - d[v] == (ui64) reverseWeights[j])) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
+			}
+			if (u != i) 
+				CB[u] += delta[u]; 
+		}
+		
+		// Clear data for the next run
+		sigma.clear(); 
+		delta.clear(); 
+		d.clear(); 
+		
+	} // End For 
+	
+	// End time after Brandes' algorithm and the time difference
+	time(&end); 
+	time_dif = difftime(end, start); 
+	cout << "It took " << time_dif << " seconds to calculate Betweenness Centrality in a graph with small whole-number weights" << endl; 
+	
+	return; 
+	
+} // End of BrandesAlgorithm_Buckets 
+
+/* 
+ * Brandes Algorithm for unweighted graphs
+ */ 
+template <class NEIGHBORS> 
+void BrandesAlgorithm_Unweighted(f64 CB[], CSR *graph, const COMPONENTS *components, f64 &time_dif) { 
+	
+	ui64 i, j, u, v;
+	uint32_t t;									// A neighbor read from the neighbor list of u
+	const uint32_t UNREACHED = numeric_limits<uint32_t>::max();	// Distance of the vertices not reached yet
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
+	
+	time_t start, end;							// Time variables
+	
+	vector<uint32_t> d;							// A vector storing shortest distance estimates
+	vector<ui64> sigma;							// sigma is the number of shortest paths
+	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
+	
+	vector <uint32_t> S;						// The vertices in the order of their distance from the source
+	
+	// Set the start time of Brandes' Algorithm
+	time(&start); 
+	
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(CB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
+	
+	// Compute Betweenness Centrality for every vertex i
+	for (i=0; i < nvertices; i++) {
+		
+		// Trivial components were done above 
+		if (trivial_vertex(components, i)) 
+			continue; 
+		
+		/* Initialize */ 
+		d.assign(nvertices, UNREACHED); 
+		d[i] = 0; 
+		sigma.assign(nvertices, 0); 
+		sigma[i] = 1; 
+		delta.assign(nvertices, 0); 
+		
+		// Find the shortest paths from i, one level at a time 
+		BreadthFirstSearch<NEIGHBORS>(graph, reverse, i, d, sigma, S); 
+					
+		/* Accumulation */ 
+		for (j=S.size()-1; j > 0; j--) { 
+			u = S[j]; 
+			// Look the predecessors of u up among its in-neighbors: those one step closer to i. The 
+			// source i comes first in S and has none 
+			NEIGHBORS in(reverse, (uint32_t) u); 
+			while (in.next(t)) { 
+				v = (ui64) t; 
+				if (d[v] == d[u] - 1) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
 			}
 			if (u != i) 
 				CB[u] += delta[u]; 
 		}
 		
 		// Clear data for the next run
-		PredList.clear(); 
+		S.clear(); 
 		d.clear(); 
 		sigma.clear(); 
 		delta.clear(); 
@@ -235,35 +444,58 @@ void BrandesAlgorithm_Unweighted(f64 CB[], NETWORK *network, f64 &time_dif) {
 } // End of BrandesAlgorithm_Unweighted 
 
 /* 
- * Brandes' Algorithm - Choose between weighted or unweighted graphs 
+ * Brandes' Algorithm - Choose the search for the way the weights are stored 
  */ 
-void BrandesAlgorithm(f64 CB[], NETWORK *network, f64 &time_dif) {
-	if ((network->MAX_Weight != 1) || (network->MIN_Weight  != 1) ) 
-		BrandesAlgorithm_Weighted(CB, network, time_dif); 
-	else 
-		BrandesAlgorithm_Unweighted(CB, network, time_dif); 
+void BrandesAlgorithm(f64 CB[], CSR *graph, const COMPONENTS *components, f64 &time_dif) {
+	switch (graph->weighttype) {
+	case WEIGHTS_U8: 
+		BrandesAlgorithm_Buckets(CB, graph, components, (const uint8_t *) graph->weights, time_dif); 
+		break; 
+	case WEIGHTS_U16: 
+		BrandesAlgorithm_Buckets(CB, graph, components, (const uint16_t *) graph->weights, time_dif); 
+		break; 
+	case WEIGHTS_U32: 
+		BrandesAlgorithm_Weighted(CB, graph, components, (const uint32_t *) graph->weights, time_dif); 
+		break; 
+	case WEIGHTS_FLOAT: 
+		BrandesAlgorithm_Weighted(CB, graph, components, (const float *) graph->weights, time_dif); 
+		break; 
+	case WEIGHTS_DOUBLE: 
+		BrandesAlgorithm_Weighted(CB, graph, components, (const double *) graph->weights, time_dif); 
+		break; 
+	default: 
+		// No weights, or the same weight on every edge: the shortest paths are those of a breadth-first search 
+		if (graph->packed != NULL) 
+			BrandesAlgorithm_Unweighted<PACKED_NEIGHBORS>(CB, graph, components, time_dif); 
+		else 
+			BrandesAlgorithm_Unweighted<PLAIN_NEIGHBORS>(CB, graph, components, time_dif); 
+	}
 	return;
-} 
+}
+
 
 /* 
- * Randomized Brandes Algorithm for weighted graphs
+ * Randomized Brandes Algorithm for weighted graphs, with a heap
  */ 
-void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f64 &time_dif) { 
+template <class W> 
+void Rand_BrandesAlgorithm_Weighted(f64 RCB[], CSR *graph, const COMPONENTS *components, const W weights[], f64 epsilon, ui64 seed, f64 &time_dif) { 
 
 	ui64 i, j, u, v, numSample, randvx;
-	ui64 nvertices = (ui64) network->nvertices;	// The number of vertices in the network
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
+	ui64 nsources = (ui64) components->nsources;	// The number of vertices sources are drawn from: those not in trivial components
 	f64 u_distance, v_distance, edgeWeight;		// Variables to store distance estimates or edge weights
 	
 	time_t start, end;							// Time variables
 	
 	vector<ui64> sigma;							// sigma is the number of shortest paths
 	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
-	vector< vector <ui64> > PredList;			// A list of predecessors of all vertices 
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
+	const W *reverseWeights = (const W *) reverse->weights;	// The weights of the in-edges
 	
-	vector<ui64> SampleVertex; 
-	vector<ui64>::iterator it;						// An iterator of vector elements
+	vector<uint32_t> SampleVertex; 
+	typename vector<uint32_t>::iterator it;					// An iterator of vector elements
 	
-	stack <ui64> S;								// A stack containing vertices in the order found by Dijkstra's Algorithm
+	stack <uint32_t> S;							// A stack containing vertices in the order found by Dijkstra's Algorithm
 	
 	FibHeap PQueue;								// A priority queue storing vertices
 	FibHeapNode nodeTemp;						// A particular node stored in the priority queue
@@ -272,6 +504,12 @@ void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f6
 	
 	// Set the start time of Randomized Brandes' Algorithm
 	time(&start); 
+	
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(RCB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
 
 	nodeVector.assign ( nvertices, NULL );
 	for (i=0; i < nvertices; i++) {
@@ -281,17 +519,18 @@ void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f6
 		nodeVector[i]->Set_key(ULONG_MAX); 
 	}
 	
-	// Generate random seed 
-	srand((unsigned)time(NULL)); 
-	
 	numSample = (ui64) (2 * (log ((f64) nvertices) / (epsilon * epsilon)));
 	
-	SampleVertex.resize(numSample); 
+	if (nsources == 0) 
+		numSample = 0; 
+	
+	SampleVertex.reserve(numSample); 
 	
 	for (i=0; i < numSample; i++) {
 		
-		// Generate a random vertex
-		randvx = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*nvertices); 
+		// Generate a random vertex, from the random numbers of sample i 
+		RNG random(seed, RNG_STREAM(RNG_RAND_BRANDES, i)); 
+		randvx = (ui64) components->sources[random.below(nsources)]; 
 		
 		// Insert the randomly sampled vertex
 		SampleVertex.push_back(randvx); 
@@ -303,7 +542,6 @@ void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f6
 		i = *it; 
 	
 		/* Initialize */ 
-		PredList.assign(nvertices, vector <ui64> (0, 0)); 
 		sigma.assign(nvertices, 0); 
 		sigma[i] = 1; 
 		delta.assign(nvertices, 0); 
@@ -322,11 +560,11 @@ void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f6
 			// Shortest path distance from source i to vertex u
 			u_distance = nodeVector[u]->Get_key(); 
 			// Iterate over all the neighbors of u 
-			for (j=0; j < (ui64) network->vertex[u].degree; j++) { 
+			for (j=graph->offsets[u]; j < (ui64) graph->offsets[u+1]; j++) { 
 				// Get the neighbor v of vertex u
-				v = (ui64) network->vertex[u].edge[j].target; 
+				v = (ui64) graph->targets[j]; 
 				// Get the weight of the edge (u,v) 
-				edgeWeight = (f64) network->vertex[u].edge[j].weight; 
+				edgeWeight = (f64) weights[j]; 
 				// If v's shortest path distance estimate has not been set yet, then 
 				// set the distance estimate of v and store v in the priority queue
 				if (nodeVector[v]->Get_key() == ULONG_MAX) {
@@ -339,12 +577,9 @@ void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f6
 				/* Relax and Count */ 
 				if (v_distance == u_distance + edgeWeight) { 
 					sigma[v] += sigma[u]; 
-					PredList[v].push_back(u); 
 				}
 				if (v_distance > u_distance + edgeWeight) {
 					sigma[v] = sigma[u]; 
-					PredList[v].clear(); 
-					PredList[v].push_back(u); 
 					nodeTemp.Set_vertexPosition(v); 
 					nodeTemp.Set_key(u_distance + edgeWeight); 
 					if (PQueue.DecreaseKey(nodeVector[v], nodeTemp) != 0) 
@@ -360,15 +595,17 @@ void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f6
 		while (!S.empty()) { 
 			u = S.top(); 
 			S.pop(); 
-			for (j=0; j < PredList[u].size(); j++) {
-				delta[PredList[u][j]] += ((f64) sigma[PredList[u][j]]/sigma[u]) * (1+delta[u]); 
+			// Look the predecessors of u up among its in-neighbors: those a shortest path to u comes through 
+			for (j=reverse->offsets[u]; j < (ui64) reverse->offsets[u+1]; j++) { 
+				v = (ui64) reverse->targets[j]; 
+				if (nodeVector[v]->Get_key() + (f64) reverseWeights[j] == nodeVector[u]->Get_key()) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
 			}
 			if (u != i) 
 				RCB[u] += delta[u]; 
 		}
 		
 		// Clear data for the next run
-		PredList.clear(); 
 		sigma.clear(); 
 		delta.clear(); 
 		for (j=0; j < nvertices; j++) 
@@ -377,7 +614,8 @@ void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f6
 	} // End For 
 	
 	for (i=0; i < nvertices; i++) 
-		RCB[i] = nvertices * (RCB[i]/numSample); 
+		if (!trivial_vertex(components, i)) 
+			RCB[i] = nsources * (RCB[i]/numSample); 
 	
 	// End time after Brandes' algorithm and the time difference
 	time(&end); 
@@ -391,42 +629,154 @@ void Rand_BrandesAlgorithm_Weighted(f64 RCB[], NETWORK *network, f64 epsilon, f6
 	
 } // End of Rand_BrandesAlgorithm_Weighted 
 
+/* 
+ * Randomized Brandes Algorithm for graphs with small whole-number weights, with a bucket queue
+ */ 
+template <class W> 
+void Rand_BrandesAlgorithm_Buckets(f64 RCB[], CSR *graph, const COMPONENTS *components, const W weights[], f64 epsilon, ui64 seed, f64 &time_dif) { 
+
+	ui64 i, j, u, v, numSample, randvx;
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
+	ui64 nsources = (ui64) components->nsources;	// The number of vertices sources are drawn from: those not in trivial components
+	
+	time_t start, end;							// Time variables
+	
+	vector<ui64> d;								// A vector storing shortest distances
+	vector<ui64> sigma;							// sigma is the number of shortest paths
+	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
+	const W *reverseWeights = (const W *) reverse->weights;	// The weights of the in-edges
+	
+	vector<uint32_t> SampleVertex; 
+	typename vector<uint32_t>::iterator it;					// An iterator of vector elements
+	
+	stack <uint32_t> S;							// A stack containing vertices in the order found by Dijkstra's Algorithm
+	
+	vector< vector <uint32_t> > Bucket;		// The bucket queue of the vertices waiting to be settled
+	
+	// Set the start time of Randomized Brandes' Algorithm
+	time(&start); 
+	
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(RCB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
+
+	// One bucket for each distance from 0 to the largest weight
+	Bucket.assign((ui64) graph->max_weight + 1, vector <uint32_t> ()); 
+	
+	numSample = (ui64) (2 * (log ((f64) nvertices) / (epsilon * epsilon)));
+	
+	if (nsources == 0) 
+		numSample = 0; 
+	
+	SampleVertex.reserve(numSample); 
+	
+	for (i=0; i < numSample; i++) {
+		
+		// Generate a random vertex, from the random numbers of sample i 
+		RNG random(seed, RNG_STREAM(RNG_RAND_BRANDES, i)); 
+		randvx = (ui64) components->sources[random.below(nsources)]; 
+		
+		// Insert the randomly sampled vertex
+		SampleVertex.push_back(randvx); 
+	}
+	
+	// Compute Randomized Betweenness Centrality using sampled vertices
+	for (it= SampleVertex.begin(); it < SampleVertex.end(); it++) {
+		
+		i = *it; 
+	
+		/* Initialize */ 
+		d.assign(nvertices, ULONG_MAX); 
+		sigma.assign(nvertices, 0); 
+		sigma[i] = 1; 
+		delta.assign(nvertices, 0); 
+		
+		// Find the shortest paths from i 
+		BucketSearch(graph, weights, i, d, sigma, Bucket, S); 
+		
+		/* Accumulation */ 
+		while (!S.empty()) { 
+			u = S.top(); 
+			S.pop(); 
+			// Look the predecessors of u up among its in-neighbors: those a shortest path to u comes through 
+			for (j=reverse->offsets[u]; j < (ui64) reverse->offsets[u+1]; j++) { 
+				v = (ui64) reverse->targets[j]; 
+				if ((d[v] < d[u]) && (d[u] - d[v] == (ui64) reverseWeights[j])) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
+			}
+			if (u != i) 
+				RCB[u] += delta[u]; 
+		}
+		
+		// Clear data for the next run
+		sigma.clear(); 
+		delta.clear(); 
+		d.clear(); 
+		
+	} // End For 
+	
+	for (i=0; i < nvertices; i++) 
+		if (!trivial_vertex(components, i)) 
+			RCB[i] = nsources * (RCB[i]/numSample); 
+	
+	// End time after Brandes' algorithm and the time difference
+	time(&end); 
+	time_dif = difftime(end, start); 
+	cout << "It took " << time_dif << " seconds to calculate Randomized Approximate Betweenness Centrality in a graph with small whole-number weights" << endl; 
+	
+	return; 
+	
+} // End of Rand_BrandesAlgorithm_Buckets 
+
 
 /* 
  * Randomized Brandes Algorithm for unweighted graphs
  */ 
-void Rand_BrandesAlgorithm_Unweighted(f64 RCB[], NETWORK *network, f64 epsilon, f64 &time_dif) { 
+template <class NEIGHBORS> 
+void Rand_BrandesAlgorithm_Unweighted(f64 RCB[], CSR *graph, const COMPONENTS *components, f64 epsilon, ui64 seed, f64 &time_dif) { 
 	
 	ui64 i, j, u, v, numSample, randvx;
-	ui64 nvertices = (ui64) network->nvertices;	// The number of vertices in the network
+	uint32_t t;									// A neighbor read from the neighbor list of u
+	const uint32_t UNREACHED = numeric_limits<uint32_t>::max();	// Distance of the vertices not reached yet
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
+	ui64 nsources = (ui64) components->nsources;	// The number of vertices sources are drawn from: those not in trivial components
 	
 	time_t start, end;							// Time variables
 	
-	vector<ui64> d;								// A vector storing shortest distance estimates
+	vector<uint32_t> d;							// A vector storing shortest distance estimates
 	vector<ui64> sigma;							// sigma is the number of shortest paths
 	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
-	vector< vector <ui64> > PredList;			// A list of predecessors of all vertices 
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
 	
-	vector<ui64> SampleVertex; 
-	vector<ui64>::iterator it;						// An iterator of vector elements
+	vector<uint32_t> SampleVertex; 
+	typename vector<uint32_t>::iterator it;					// An iterator of vector elements
 	
-	queue <ui64> Q;								// A priority queue soring vertices
-	stack <ui64> S;								// A stack containing vertices in the order found by Dijkstra's Algorithm
+	vector <uint32_t> S;						// The vertices in the order of their distance from the source
 	
 	// Set the start time of Brandes' Algorithm
 	time(&start); 
 	
-	// Generate random seed 
-	srand((unsigned)time(NULL)); 
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(RCB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
 	
 	numSample = (ui64) (2 * (log ((f64) nvertices) / (epsilon * epsilon))); 
 	
-	SampleVertex.resize(numSample); 
+	if (nsources == 0) 
+		numSample = 0; 
+	
+	SampleVertex.reserve(numSample); 
 	
 	for (i=0; i < numSample; i++) {
 		
-		// Generate a random vertex
-		randvx = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*nvertices); 
+		// Generate a random vertex, from the random numbers of sample i 
+		RNG random(seed, RNG_STREAM(RNG_RAND_BRANDES, i)); 
+		randvx = (ui64) components->sources[random.below(nsources)]; 
 		
 		// Insert the randomly sampled vertex
 		SampleVertex.push_back(randvx); 
@@ -438,52 +788,32 @@ void Rand_BrandesAlgorithm_Unweighted(f64 RCB[], NETWORK *network, f64 epsilon,
 		i = *it; 
 		
 		/* Initialize */ 
-		PredList.assign(nvertices, vector <ui64> (0, 0)); 
-		d.assign(nvertices, ULONG_MAX); 
+		d.assign(nvertices, UNREACHED); 
 		d[i] = 0; 
 		sigma.assign(nvertices, 0); 
 		sigma[i] = 1; 
 		delta.assign(nvertices, 0); 
-		Q.push(i); 
 		
-		// Use Breadth First Search algorithm 
-		while (!Q.empty()) {
-			// Get the next element in the queue
-			u = Q.front(); 
-			Q.pop(); 
-			// Push u onto the stack S. Needed later for betweenness computation
-			S.push(u); 
-			// Iterate over all the neighbors of u 
-			for (j=0; j < (ui64) network->vertex[u].degree; j++) { 
-				// Get the neighbor v of vertex u
-				v = (ui64) network->vertex[u].edge[j].target; 
-				
-				/* Relax and Count */
-				if (d[v] == ULONG_MAX) { 
-					d[v] = d[u] + 1; 
-					Q.push(v); 
-				} 
-				if (d[v] == d[u] + 1) {
-					sigma[v] += sigma[u]; 
-					PredList[v].push_back(u); 
-				}
-			} // End For
-			
-		} // End While 
+		// Find the shortest paths from i, one level at a time 
+		BreadthFirstSearch<NEIGHBORS>(graph, reverse, i, d, sigma, S); 
 		
 		/* Accumulation */ 
-		while (!S.empty()) { 
-			u = S.top(); 
-			S.pop(); 
-			for (j=0; j < PredList[u].size(); j++) {
-				delta[PredList[u][j]] += ((f64) sigma[PredList[u][j]]/sigma[u]) * (1+delta[u]); 
+		for (j=S.size()-1; j > 0; j--) { 
+			u = S[j]; 
+			// Look the predecessors of u up among its in-neighbors: those one step closer to i. The 
+			// source i comes first in S and has none 
+			NEIGHBORS in(reverse, (uint32_t) u); 
+			while (in.next(t)) { 
+				v = (ui64) t; 
+				if (d[v] == d[u] - 1) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
 			}
 			if (u != i) 
 				RCB[u] += delta[u]; 
 		}
 		
 		// Clear data for the next run
-		PredList.clear(); 
+		S.clear(); 
 		d.clear(); 
 		sigma.clear(); 
 		delta.clear(); 
@@ -491,7 +821,8 @@ void Rand_BrandesAlgorithm_Unweighted(f64 RCB[], NETWORK *network, f64 epsilon,
 	} // End For 
 	
 	for (i=0; i < nvertices; i++) 
-		RCB[i] = nvertices * (RCB[i]/numSample); 
+		if (!trivial_vertex(components, i)) 
+			RCB[i] = nsources * (RCB[i]/numSample); 
 	
 	// End time after Brandes' algorithm and the time difference
 	time(&end); 
@@ -502,24 +833,46 @@ void Rand_BrandesAlgorithm_Unweighted(f64 RCB[], NETWORK *network, f64 epsilon,
 } // End of Rand_BrandesAlgorithm_Unweighted 
 
 /* 
- * Randomized Brandes' Algorithm - Choose between weighted or unweighted graphs 
+ * Randomized Brandes' Algorithm - Choose the search for the way the weights are stored 
  */ 
-void Rand_BrandesAlgorithm(f64 RCB[], NETWORK *network, f64 epsilon, f64 &time_dif) {
-	if ((network->MAX_Weight != 1) || (network->MIN_Weight  != 1) ) 
-		Rand_BrandesAlgorithm_Weighted(RCB, network, epsilon, time_dif); 
-	else 
-		Rand_BrandesAlgorithm_Unweighted(RCB, network, epsilon, time_dif); 
+void Rand_BrandesAlgorithm(f64 RCB[], CSR *graph, const COMPONENTS *components, f64 epsilon, ui64 seed, f64 &time_dif) {
+	switch (graph->weighttype) {
+	case WEIGHTS_U8: 
+		Rand_BrandesAlgorithm_Buckets(RCB, graph, components, (const uint8_t *) graph->weights, epsilon, seed, time_dif); 
+		break; 
+	case WEIGHTS_U16: 
+		Rand_BrandesAlgorithm_Buckets(RCB, graph, components, (const uint16_t *) graph->weights, epsilon, seed, time_dif); 
+		break; 
+	case WEIGHTS_U32: 
+		Rand_BrandesAlgorithm_Weighted(RCB, graph, components, (const uint32_t *) graph->weights, epsilon, seed, time_dif); 
+		break; 
+	case WEIGHTS_FLOAT: 
+		Rand_BrandesAlgorithm_Weighted(RCB, graph, components, (const float *) graph->weights, epsilon, seed, time_dif); 
+		break; 
+	case WEIGHTS_DOUBLE: 
+		Rand_BrandesAlgorithm_Weighted(RCB, graph, components, (const double *) graph->weights, epsilon, seed, time_dif); 
+		break; 
+	default: 
+		// No weights, or the same weight on every edge: the shortest paths are those of a breadth-first search 
+		if (graph->packed != NULL) 
+			Rand_BrandesAlgorithm_Unweighted<PACKED_NEIGHBORS>(RCB, graph, components, epsilon, seed, time_dif); 
+		else 
+			Rand_BrandesAlgorithm_Unweighted<PLAIN_NEIGHBORS>(RCB, graph, components, epsilon, seed, time_dif); 
+	}
 	return;
-} 
+}
+
 
 
 /* 	 
- * Adaptive Randomized Sampling Algorithm for Weighted graphs. The cut-off on the number of samples is n/20. 
+ * Adaptive Randomized Sampling Algorithm for weighted graphs, with a heap. The cut-off on the number of samples is n/20. 
 */ 
-void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup, f64 &time_dif) { 
+template <class W> 
+void Adaptive_Sampling_Weighted(f64 ACB[], CSR *graph, const COMPONENTS *components, const W weights[], f64 c_thr, f64 sup, ui64 seed, f64 &time_dif) { 
 	
 	ui64 i, j, u, v, numSample, randvx;
-	ui64 nvertices = (ui64) network->nvertices;	// The number of vertices in the network
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
+	ui64 nsources = (ui64) components->nsources;	// The number of vertices sources are drawn from: those not in trivial components
 	ui64 count = 0; 
 	f64 u_distance, v_distance, edgeWeight;		// Variables to store distance estimates or edge weights
 	
@@ -527,13 +880,14 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 	
 	vector<ui64> sigma;							// sigma is the number of shortest paths
 	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
-	vector< vector <ui64> > PredList;			// A list of predecessors of all vertices 
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
+	const W *reverseWeights = (const W *) reverse->weights;	// The weights of the in-edges
 	
-	vector<ui64> SampleVertex; 
-	vector<ui64>::iterator it;					// An iterator of vector elements
+	vector<uint32_t> SampleVertex; 
+	typename vector<uint32_t>::iterator it;				// An iterator of vector elements
 	vector<bool> Flag; 
 	
-	stack <ui64> S;								// A stack containing vertices in the order found by Dijkstra's Algorithm
+	stack <uint32_t> S;							// A stack containing vertices in the order found by Dijkstra's Algorithm
 	
 	FibHeap PQueue;								// A priority queue storing vertices
 	FibHeapNode nodeTemp;						// A particular node stored in the priority queue
@@ -542,6 +896,12 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 	
 	// Set the start time of Randomized Brandes' Algorithm
 	time(&start); 
+	
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(ACB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
 
 	nodeVector.assign ( nvertices, NULL );
 	for (i=0; i < nvertices; i++) {
@@ -551,21 +911,27 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 		nodeVector[i]->Set_key(ULONG_MAX); 
 	}
 	
-	// Generate random seed 
-	srand((unsigned)time(NULL)); 
-	
 	numSample = (ui64) (nvertices/sup); 
 	
 	if (numSample < 1) 
 		numSample = nvertices; 
 	
-	SampleVertex.resize(numSample); 
+	if (nsources == 0) 
+		numSample = 0; 
+	
+	SampleVertex.reserve(numSample); 
 	Flag.assign(nvertices, false); 
 	
+	// The values of trivial components are exact already 
+	for (i=0; i < nvertices; i++) 
+		if (trivial_vertex(components, i)) 
+			Flag[i] = true; 
+	
 	for (i=0; i < numSample; i++) {
 		
-		// Generate a random vertex
-		randvx = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*nvertices); 
+		// Generate a random vertex, from the random numbers of sample i 
+		RNG random(seed, RNG_STREAM(RNG_ADAPTIVE_SAMPLING, i)); 
+		randvx = (ui64) components->sources[random.below(nsources)]; 
 		
 		// Insert the randomly sampled vertex
 		SampleVertex.push_back(randvx); 
@@ -578,7 +944,6 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 		i = *it; 
 		
 		/* Initialize */ 
-		PredList.assign(nvertices, vector <ui64> (0, 0)); 
 		sigma.assign(nvertices, 0); 
 		sigma[i] = 1; 
 		delta.assign(nvertices, 0); 
@@ -597,11 +962,11 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 			// Shortest path distance from source i to vertex u
 			u_distance = nodeVector[u]->Get_key(); 
 			// Iterate over all the neighbors of u 
-			for (j=0; j < (ui64) network->vertex[u].degree; j++) { 
+			for (j=graph->offsets[u]; j < (ui64) graph->offsets[u+1]; j++) { 
 				// Get the neighbor v of vertex u
-				v = (ui64) network->vertex[u].edge[j].target; 
+				v = (ui64) graph->targets[j]; 
 				// Get the weight of the edge (u,v) 
-				edgeWeight = (f64) network->vertex[u].edge[j].weight; 
+				edgeWeight = (f64) weights[j]; 
 				// If v's shortest path distance estimate has not been set yet, then 
 				// set the distance estimate of v and store v in the priority queue
 				if (nodeVector[v]->Get_key() == ULONG_MAX) {
@@ -614,12 +979,9 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 				/* Relax and Count */ 
 				if (v_distance == u_distance + edgeWeight) { 
 					sigma[v] += sigma[u]; 
-					PredList[v].push_back(u); 
 				}
 				if (v_distance > u_distance + edgeWeight) {
 					sigma[v] = sigma[u]; 
-					PredList[v].clear(); 
-					PredList[v].push_back(u); 
 					nodeTemp.Set_vertexPosition(v); 
 					nodeTemp.Set_key(u_distance + edgeWeight); 
 					if (PQueue.DecreaseKey(nodeVector[v], nodeTemp) != 0) 
@@ -635,14 +997,17 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 		while (!S.empty()) { 
 			u = S.top(); 
 			S.pop(); 
-			for (j=0; j < PredList[u].size(); j++) {
-				delta[PredList[u][j]] += ((f64) sigma[PredList[u][j]]/sigma[u]) * (1+delta[u]); 
+			// Look the predecessors of u up among its in-neighbors: those a shortest path to u comes through 
+			for (j=reverse->offsets[u]; j < (ui64) reverse->offsets[u+1]; j++) { 
+				v = (ui64) reverse->targets[j]; 
+				if (nodeVector[v]->Get_key() + (f64) reverseWeights[j] == nodeVector[u]->Get_key()) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
 			}
 			
 			if ((u != i) && (!Flag[u])) {
 				ACB[u] += delta[u]; 
 				if (ACB[u] > c_thr * nvertices) {
-					ACB[u] = nvertices * (ACB[u]/count);
+					ACB[u] = nsources * (ACB[u]/count);
 					Flag[u] = true;
 				}
 			} // End If 
@@ -650,7 +1015,6 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 		} // End While
 		
 		// Clear data for the next run
-		PredList.clear(); 
 		sigma.clear(); 
 		delta.clear(); 
 		for (j=0; j < nvertices; j++) 
@@ -660,7 +1024,7 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 	
 	for (i=0; i < nvertices; i++) {
 		if (!Flag[i]) {
-			ACB[i] = nvertices * (ACB[i]/numSample); 
+			ACB[i] = nsources * (ACB[i]/numSample); 
 		}
 	}
 	
@@ -676,47 +1040,185 @@ void Adaptive_Sampling_Weighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup,
 	
 } // End of Adaptive_Sampling_Weighted 
 
+/* 	 
+ * Adaptive Randomized Sampling Algorithm for graphs with small whole-number weights, with a bucket queue. The cut-off on the number of samples is n/20. 
+*/ 
+template <class W> 
+void Adaptive_Sampling_Buckets(f64 ACB[], CSR *graph, const COMPONENTS *components, const W weights[], f64 c_thr, f64 sup, ui64 seed, f64 &time_dif) { 
+	
+	ui64 i, j, u, v, numSample, randvx;
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
+	ui64 nsources = (ui64) components->nsources;	// The number of vertices sources are drawn from: those not in trivial components
+	ui64 count = 0; 
+	
+	time_t start, end;							// Time variables
+	
+	vector<ui64> d;								// A vector storing shortest distances
+	vector<ui64> sigma;							// sigma is the number of shortest paths
+	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
+	const W *reverseWeights = (const W *) reverse->weights;	// The weights of the in-edges
+	
+	vector<uint32_t> SampleVertex; 
+	typename vector<uint32_t>::iterator it;				// An iterator of vector elements
+	vector<bool> Flag; 
+	
+	stack <uint32_t> S;							// A stack containing vertices in the order found by Dijkstra's Algorithm
+	
+	vector< vector <uint32_t> > Bucket;		// The bucket queue of the vertices waiting to be settled
+	
+	// Set the start time of Randomized Brandes' Algorithm
+	time(&start); 
+	
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(ACB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
+
+	// One bucket for each distance from 0 to the largest weight
+	Bucket.assign((ui64) graph->max_weight + 1, vector <uint32_t> ()); 
+	
+	numSample = (ui64) (nvertices/sup); 
+	
+	if (numSample < 1) 
+		numSample = nvertices; 
+	
+	if (nsources == 0) 
+		numSample = 0; 
+	
+	SampleVertex.reserve(numSample); 
+	Flag.assign(nvertices, false); 
+	
+	// The values of trivial components are exact already 
+	for (i=0; i < nvertices; i++) 
+		if (trivial_vertex(components, i)) 
+			Flag[i] = true; 
+	
+	for (i=0; i < numSample; i++) {
+		
+		// Generate a random vertex, from the random numbers of sample i 
+		RNG random(seed, RNG_STREAM(RNG_ADAPTIVE_SAMPLING, i)); 
+		randvx = (ui64) components->sources[random.below(nsources)]; 
+		
+		// Insert the randomly sampled vertex
+		SampleVertex.push_back(randvx); 
+	}
+	
+	// Compute Randomized Betweenness Centrality using sampled vertices
+	for (it= SampleVertex.begin(); it < SampleVertex.end(); it++) {
+		
+		count += 1;
+		i = *it; 
+		
+		/* Initialize */ 
+		d.assign(nvertices, ULONG_MAX); 
+		sigma.assign(nvertices, 0); 
+		sigma[i] = 1; 
+		delta.assign(nvertices, 0); 
+		
+		// Find the shortest paths from i 
+		BucketSearch(graph, weights, i, d, sigma, Bucket, S); 
+		
+		/* Accumulation */ 
+		while (!S.empty()) { 
+			u = S.top(); 
+			S.pop(); 
+			// Look the predecessors of u up among its in-neighbors: those a shortest path to u comes through 
+			for (j=reverse->offsets[u]; j < (ui64) reverse->offsets[u+1]; j++) { 
+				v = (ui64) reverse->targets[j]; 
+				if ((d[v] < d[u]) && (d[u] - d[v] == (ui64) reverseWeights[j])) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
+			}
+			
+			if ((u != i) && (!Flag[u])) {
+				ACB[u] += delta[u]; 
+				if (ACB[u] > c_thr * nvertices) {
+					ACB[u] = nsources * (ACB[u]/count);
+					Flag[u] = true;
+				}
+			} // End If 
+			
+		} // End While
+		
+		// Clear data for the next run
+		sigma.clear(); 
+		delta.clear(); 
+		d.clear(); 
+		
+	} // End For 
+	
+	for (i=0; i < nvertices; i++) {
+		if (!Flag[i]) {
+			ACB[i] = nsources * (ACB[i]/numSample); 
+		}
+	}
+	
+	// End time after Brandes' algorithm and the time difference
+	time(&end); 
+	time_dif = difftime(end, start); 
+	cout << "It took " << time_dif << " seconds to calculate Adaptive Sampling Based Approximate Centrality Values in a graph with small whole-number weights" << endl;
+	
+	return; 
+	
+} // End of Adaptive_Sampling_Buckets 
+
 
 /* 
  * Adaptive Randomized Sampling Algorithm for unweighted graphs. The cut-off on the number of samples is n/sup 
  */ 
-void Adaptive_Sampling_Unweighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup, f64 &time_dif) { 
+template <class NEIGHBORS> 
+void Adaptive_Sampling_Unweighted(f64 ACB[], CSR *graph, const COMPONENTS *components, f64 c_thr, f64 sup, ui64 seed, f64 &time_dif) { 
 	
 	ui64 i, j, u, v, numSample, randvx;
-	ui64 nvertices = (ui64) network->nvertices;	// The number of vertices in the network
+	uint32_t t;									// A neighbor read from the neighbor list of u
+	const uint32_t UNREACHED = numeric_limits<uint32_t>::max();	// Distance of the vertices not reached yet
+	ui64 nvertices = (ui64) graph->nvertices;	// The number of vertices in the network
+	ui64 nsources = (ui64) components->nsources;	// The number of vertices sources are drawn from: those not in trivial components
 	ui64 count = 0; 
 	
 	time_t start, end;							// Time variables
 	
-	vector<ui64> d;								// A vector storing shortest distance estimates
+	vector<uint32_t> d;							// A vector storing shortest distance estimates
 	vector<ui64> sigma;							// sigma is the number of shortest paths
 	vector<f64> delta;							// A vector storing dependency of the source vertex on all other vertices
-	vector< vector <ui64> > PredList;			// A list of predecessors of all vertices 
+	CSR *reverse = in_edges(graph);			// The in-edges, among which the predecessors of a vertex are looked up
 	
-	vector<ui64> SampleVertex; 
-	vector<ui64>::iterator it;						// An iterator of vector elements
+	vector<uint32_t> SampleVertex; 
+	typename vector<uint32_t>::iterator it;					// An iterator of vector elements
 	vector<bool> Flag; 
 	
-	queue <ui64> Q;								// A priority queue soring vertices
-	stack <ui64> S;								// A stack containing vertices in the order found by Dijkstra's Algorithm
+	vector <uint32_t> S;						// The vertices in the order of their distance from the source
 	
 	// Set the start time of Brandes' Algorithm
 	time(&start); 
 	
-	// Generate random seed 
-	srand((unsigned)time(NULL)); 
+	// The betweenness of isolated vertices, pairs and trees is known without a search 
+	if (trivial_betweenness(ACB, components, graph) != 0) { 
+		cout << "Allocating memory for the trivial components failed." << endl; 
+		return; 
+	}
 	
 	numSample = (ui64) (nvertices/sup); 
 	if (numSample < 1) 
 		numSample = nvertices; 
 	
-	SampleVertex.resize(numSample); 
+	if (nsources == 0) 
+		numSample = 0; 
+	
+	SampleVertex.reserve(numSample); 
 	Flag.assign(nvertices, false); 
 	
+	// The values of trivial components are exact already 
+	for (i=0; i < nvertices; i++) 
+		if (trivial_vertex(components, i)) 
+			Flag[i] = true; 
+	
 	for (i=0; i < numSample; i++) {
 		
-		// Generate a random vertex
-		randvx = (ui64) ((((f64) rand())/((f64) RAND_MAX + 1.0))*nvertices);
+		// Generate a random vertex, from the random numbers of sample i 
+		RNG random(seed, RNG_STREAM(RNG_ADAPTIVE_SAMPLING, i)); 
+		randvx = (ui64) components->sources[random.below(nsources)];
 		
 		// Insert the randomly sampled vertex
 		SampleVertex.push_back(randvx); 
@@ -729,51 +1231,31 @@ void Adaptive_Sampling_Unweighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 su
 		i = *it; 
 		
 		/* Initialize */ 
-		PredList.assign(nvertices, vector <ui64> (0, 0)); 
-		d.assign(nvertices, ULONG_MAX); 
+		d.assign(nvertices, UNREACHED); 
 		d[i] = 0; 
 		sigma.assign(nvertices, 0); 
 		sigma[i] = 1; 
 		delta.assign(nvertices, 0); 
-		Q.push(i); 
 		
-		// Use Breadth First Search algorithm 
-		while (!Q.empty()) {
-			// Get the next element in the queue
-			u = Q.front(); 
-			Q.pop(); 
-			// Push u onto the stack S. Needed later for betweenness computation
-			S.push(u); 
-			// Iterate over all the neighbors of u 
-			for (j=0; j < (ui64) network->vertex[u].degree; j++) { 
-				// Get the neighbor v of vertex u
-				v = (ui64) network->vertex[u].edge[j].target; 
-				
-				/* Relax and Count */
-				if (d[v] == ULONG_MAX) { 
-					d[v] = d[u] + 1; 
-					Q.push(v); 
-				} 
-				if (d[v] == d[u] + 1) {
-					sigma[v] += sigma[u]; 
-					PredList[v].push_back(u); 
-				}
-			} // End For
-			
-		} // End While 
+		// Find the shortest paths from i, one level at a time 
+		BreadthFirstSearch<NEIGHBORS>(graph, reverse, i, d, sigma, S); 
 		
 		/* Accumulation */ 
-		while (!S.empty()) { 
-			u = S.top(); 
-			S.pop(); 
-			for (j=0; j < PredList[u].size(); j++) {
-				delta[PredList[u][j]] += ((f64) sigma[PredList[u][j]]/sigma[u]) * (1+delta[u]); 
+		for (j=S.size()-1; j > 0; j--) { 
+			u = S[j]; 
+			// Look the predecessors of u up among its in-neighbors: those one step closer to i. The 
+			// source i comes first in S and has none 
+			NEIGHBORS in(reverse, (uint32_t) u); 
+			while (in.next(t)) { 
+				v = (ui64) t; 
+				if (d[v] == d[u] - 1) 
+					delta[v] += ((f64) sigma[v]/sigma[u]) * (1+delta[u]); 
 			}
 			
 			if ((u != i) && (!Flag[u])) {
 				ACB[u] += delta[u]; 
 				if (ACB[u] > c_thr * nvertices) {
-					ACB[u] = nvertices * (ACB[u]/count);
+					ACB[u] = nsources * (ACB[u]/count);
 					Flag[u] = true;
 				}
 			} // End If 
@@ -781,7 +1263,7 @@ void Adaptive_Sampling_Unweighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 su
 		} // End While
 		
 		// Clear data for the next run
-		PredList.clear(); 
+		S.clear(); 
 		d.clear(); 
 		sigma.clear(); 
 		delta.clear(); 
@@ -790,7 +1272,7 @@ void Adaptive_Sampling_Unweighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 su
 	
 	for (i=0; i < nvertices; i++) {
 		if (!Flag[i]) {
-			ACB[i] = nvertices * (ACB[i]/numSample); 
+			ACB[i] = nsources * (ACB[i]/numSample); 
 		}
 	}
 	
@@ -805,12 +1287,32 @@ void Adaptive_Sampling_Unweighted(f64 ACB[], NETWORK *network, f64 c_thr, f64 su
 
 
 /* 
- *  Adaptive Sampling Based Randomized Approximation Algorithm - Choose between weighted or unweighted graphs 
+ *  Adaptive Sampling Based Randomized Approximation Algorithm - Choose the search for the way the weights are stored 
  */ 
-void Adaptive_Sampling_Algorithm(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup, f64 &time_dif) {
-	if ((network->MAX_Weight != 1) || (network->MIN_Weight  != 1) ) 
-		Adaptive_Sampling_Weighted(ACB, network, c_thr, sup, time_dif); 
-	else 
-		Adaptive_Sampling_Unweighted(ACB, network, c_thr, sup, time_dif); 
+void Adaptive_Sampling_Algorithm(f64 ACB[], CSR *graph, const COMPONENTS *components, f64 c_thr, f64 sup, ui64 seed, f64 &time_dif) {
+	switch (graph->weighttype) {
+	case WEIGHTS_U8: 
+		Adaptive_Sampling_Buckets(ACB, graph, components, (const uint8_t *) graph->weights, c_thr, sup, seed, time_dif); 
+		break; 
+	case WEIGHTS_U16: 
+		Adaptive_Sampling_Buckets(ACB, graph, components, (const uint16_t *) graph->weights, c_thr, sup, seed, time_dif); 
+		break; 
+	case WEIGHTS_U32: 
+		Adaptive_Sampling_Weighted(ACB, graph, components, (const uint32_t *) graph->weights, c_thr, sup, seed, time_dif); 
+		break; 
+	case WEIGHTS_FLOAT: 
+		Adaptive_Sampling_Weighted(ACB, graph, components, (const float *) graph->weights, c_thr, sup, seed, time_dif); 
+		break; 
+	case WEIGHTS_DOUBLE: 
+		Adaptive_Sampling_Weighted(ACB, graph, components, (const double *) graph->weights, c_thr, sup, seed, time_dif); 
+		break; 
+	default: 
+		// No weights, or the same weight on every edge: the shortest paths are those of a breadth-first search 
+		if (graph->packed != NULL) 
+			Adaptive_Sampling_Unweighted<PACKED_NEIGHBORS>(ACB, graph, components, c_thr, sup, seed, time_dif); 
+		else 
+			Adaptive_Sampling_Unweighted<PLAIN_NEIGHBORS>(ACB, graph, components, c_thr, sup, seed, time_dif); 
+	}
 	return;
 }
+
@@ -41,13 +41,18 @@ typedef int i32;
 #include<time.h>
 #include<math.h> 
 #include <limits.h>
-#include "network.h"
+#include <limits>
+#include "csr.h"
+#include "components.h"
+#include "rng.h"
 #include "fibheap.h"
 
 using namespace std;
 
-void BrandesAlgorithm(f64 CB[], NETWORK *network, f64 &time_dif);
-void Rand_BrandesAlgorithm(f64 RCB[], NETWORK *network, f64 epsilon, f64 &time_dif);
-void Adaptive_Sampling_Algorithm(f64 ACB[], NETWORK *network, f64 c_thr, f64 sup, f64 &time_dif);
+#define BOTTOMUP_SCAN 16		// Vertices a bottom-up search step checks for the cost of following one edge
+
+void BrandesAlgorithm(f64 CB[], CSR *graph, const COMPONENTS *components, f64 &time_dif);
+void Rand_BrandesAlgorithm(f64 RCB[], CSR *graph, const COMPONENTS *components, f64 epsilon, ui64 seed, f64 &time_dif);
+void Adaptive_Sampling_Algorithm(f64 ACB[], CSR *graph, const COMPONENTS *components, f64 c_thr, f64 sup, ui64 seed, f64 &time_dif);
 
 #endif
@@ -0,0 +1,372 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Reading of gzip- and zstd-compressed input.  See "decoder.h".
+
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "decoder.h"
+
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+#ifdef HAVE_ZSTD
+#include <zstd.h>
+#endif
+
+#define PEEKLENGTH 65536         // Compressed text read to guess a format
+
+
+// Function to work out the compression of a stream from its magic number
+
+int stream_compression(FILE *stream)
+{
+  int c;
+  long offset;
+  ssize_t n;
+  unsigned char magic[4];
+  struct stat info;
+
+  offset = ftell(stream);
+  if ((offset>=0)&&(fstat(fileno(stream),&info)==0)&&S_ISREG(info.st_mode)) {
+    n = pread(fileno(stream),magic,4,offset);
+  } else {
+    c = getc(stream);
+    if (c==EOF) return COMPRESSION_NONE;
+    ungetc(c,stream);
+    magic[0] = c;
+    n = 1;
+  }
+
+  // Streams we cannot look ahead in are recognized by their first
+  // character, which is never 0x1f or '(' at the start of a text network
+
+  if ((n>=1)&&(magic[0]==0x1f)&&((n==1)||(magic[1]==0x8b))) return COMPRESSION_GZIP;
+  if ((n>=1)&&(magic[0]==0x28)
+      &&((n==1)||((n==4)&&(magic[1]==0xb5)&&(magic[2]==0x2f)&&(magic[3]==0xfd))))
+    return COMPRESSION_ZSTD;
+  return COMPRESSION_NONE;
+}
+
+
+// Function to put decompressed text into the ring, waiting for space as
+// needed.  Returns 1 if the consumer has stopped, otherwise 0.
+
+int ring_put(DECODER *decoder, const char *data, size_t length)
+{
+  size_t pos,n;
+
+  pthread_mutex_lock(&decoder->lock);
+  while (length>0) {
+    while ((decoder->written-decoder->read==RINGLENGTH)&&!decoder->stop)
+      pthread_cond_wait(&decoder->changed,&decoder->lock);
+    if (decoder->stop) break;
+
+    // The free part of the ring belongs to the producer until "written"
+    // moves past it, so it can be filled without holding the lock
+
+    pos = decoder->written % RINGLENGTH;
+    n = RINGLENGTH - (decoder->written-decoder->read);
+    if (n>RINGLENGTH-pos) n = RINGLENGTH - pos;
+    if (n>length) n = length;
+    pthread_mutex_unlock(&decoder->lock);
+    memcpy(decoder->ring+pos,data,n);
+    pthread_mutex_lock(&decoder->lock);
+
+    decoder->written += n;
+    data += n;
+    length -= n;
+    pthread_cond_broadcast(&decoder->changed);
+  }
+  pthread_mutex_unlock(&decoder->lock);
+
+  return decoder->stop;
+}
+
+
+#ifdef HAVE_ZLIB
+
+// Function to decompress a gzip stream, which may hold several members one
+// after the other.  Returns 1 if the stream is corrupt or truncated.
+
+int decode_gzip(DECODER *decoder, char *in, char *out)
+{
+  int status;
+  z_stream z;
+
+  memset(&z,0,sizeof(z));
+  if (inflateInit2(&z,15+32)!=Z_OK) return 1;
+
+  status = Z_OK;
+  while (1) {
+    if (z.avail_in==0) {
+      z.next_in = (Bytef*) in;
+      z.avail_in = fread(in,1,DECODEBLOCK,decoder->stream);
+      if (z.avail_in==0) break;
+    }
+    if (status==Z_STREAM_END) inflateReset(&z);
+    z.next_out = (Bytef*) out;
+    z.avail_out = DECODEBLOCK;
+    status = inflate(&z,Z_NO_FLUSH);
+    if ((status!=Z_OK)&&(status!=Z_STREAM_END)&&(status!=Z_BUF_ERROR)) break;
+    if (ring_put(decoder,out,DECODEBLOCK-z.avail_out)) {
+      status = Z_STREAM_END;
+      break;
+    }
+  }
+  inflateEnd(&z);
+
+  return status!=Z_STREAM_END;
+}
+
+#endif
+
+
+#ifdef HAVE_ZSTD
+
+// Function to decompress a zstd stream, which may hold several frames one
+// after the other.  Returns 1 if the stream is corrupt or truncated.
+
+int decode_zstd(DECODER *decoder, char *in, char *out)
+{
+  size_t status;
+  ZSTD_DStream *z;
+  ZSTD_inBuffer input;
+  ZSTD_outBuffer output;
+
+  z = ZSTD_createDStream();
+  if (z==NULL) return 1;
+  ZSTD_initDStream(z);
+
+  input.src = in;
+  input.size = input.pos = 0;
+  status = 0;
+  while (1) {
+    if (input.pos==input.size) {
+      input.size = fread(in,1,DECODEBLOCK,decoder->stream);
+      input.pos = 0;
+      if (input.size==0) break;
+    }
+    output.dst = out;
+    output.size = DECODEBLOCK;
+    output.pos = 0;
+    status = ZSTD_decompressStream(z,&output,&input);
+    if (ZSTD_isError(status)) break;
+    if (ring_put(decoder,out,output.pos)) {
+      status = 0;
+      break;
+    }
+  }
+  ZSTD_freeDStream(z);
+
+  // A frame that is not finished means the input was cut short
+
+  return status!=0;
+}
+
+#endif
+
+
+// Thread function of the producer
+
+void *decode_stream(void *arg)
+{
+  int error=1;
+  char *in,*out;
+  DECODER *decoder = (DECODER*) arg;
+
+  in = (char*) malloc(DECODEBLOCK);
+  out = (char*) malloc(DECODEBLOCK);
+  if ((in!=NULL)&&(out!=NULL)) {
+#ifdef HAVE_ZLIB
+    if (decoder->type==COMPRESSION_GZIP) error = decode_gzip(decoder,in,out);
+#endif
+#ifdef HAVE_ZSTD
+    if (decoder->type==COMPRESSION_ZSTD) error = decode_zstd(decoder,in,out);
+#endif
+  }
+  free(in);
+  free(out);
+
+  pthread_mutex_lock(&decoder->lock);
+  decoder->error = error;
+  decoder->done = 1;
+  pthread_cond_broadcast(&decoder->changed);
+  pthread_mutex_unlock(&decoder->lock);
+
+  return NULL;
+}
+
+
+// Function to start decompressing a stream
+
+int open_decoder(DECODER *decoder, FILE *stream, int type)
+{
+  memset(decoder,0,sizeof(DECODER));
+
+#ifndef HAVE_ZLIB
+  if (type==COMPRESSION_GZIP) {
+    fprintf(stderr,"This build cannot read gzip files; rebuild with zlib installed\n");
+    return 1;
+  }
+#endif
+#ifndef HAVE_ZSTD
+  if (type==COMPRESSION_ZSTD) {
+    fprintf(stderr,"This build cannot read zstd files; rebuild with libzstd installed\n");
+    return 1;
+  }
+#endif
+
+  decoder->stream = stream;
+  decoder->type = type;
+  decoder->ring = (char*) malloc(RINGLENGTH);
+  if (decoder->ring==NULL) return 1;
+  pthread_mutex_init(&decoder->lock,NULL);
+  pthread_cond_init(&decoder->changed,NULL);
+
+  if (pthread_create(&decoder->thread,NULL,decode_stream,decoder)!=0) {
+    pthread_mutex_destroy(&decoder->lock);
+    pthread_cond_destroy(&decoder->changed);
+    free(decoder->ring);
+    decoder->ring = NULL;
+    return 1;
+  }
+
+  return 0;
+}
+
+
+// Function to take decompressed text out of the ring
+
+size_t decoder_read(DECODER *decoder, char *buffer, size_t length)
+{
+  size_t pos,n,total=0;
+
+  pthread_mutex_lock(&decoder->lock);
+  while ((decoder->written==decoder->read)&&!decoder->done)
+    pthread_cond_wait(&decoder->changed,&decoder->lock);
+
+  // Take what is there, in at most two pieces if it wraps around the end
+  // of the ring
+
+  while ((length>0)&&(decoder->written>decoder->read)) {
+    pos = decoder->read % RINGLENGTH;
+    n = decoder->written - decoder->read;
+    if (n>RINGLENGTH-pos) n = RINGLENGTH - pos;
+    if (n>length) n = length;
+    pthread_mutex_unlock(&decoder->lock);
+    memcpy(buffer,decoder->ring+pos,n);
+    pthread_mutex_lock(&decoder->lock);
+
+    decoder->read += n;
+    buffer += n;
+    length -= n;
+    total += n;
+    pthread_cond_broadcast(&decoder->changed);
+  }
+  pthread_mutex_unlock(&decoder->lock);
+
+  return total;
+}
+
+
+// Function to stop the producer and free the decoder again
+
+void close_decoder(DECODER *decoder)
+{
+  if (decoder->ring==NULL) return;
+
+  pthread_mutex_lock(&decoder->lock);
+  decoder->stop = 1;
+  pthread_cond_broadcast(&decoder->changed);
+  pthread_mutex_unlock(&decoder->lock);
+  pthread_join(decoder->thread,NULL);
+
+  pthread_mutex_destroy(&decoder->lock);
+  pthread_cond_destroy(&decoder->changed);
+  free(decoder->ring);
+  decoder->ring = NULL;
+}
+
+
+// Function to decompress the start of a regular file
+
+size_t peek_decompressed(FILE *stream, int type, char *buffer, size_t length)
+{
+  long offset;
+  ssize_t n;
+  size_t result=0;
+  char *in;
+
+  offset = ftell(stream);
+  if (offset<0) return 0;
+  in = (char*) malloc(PEEKLENGTH);
+  if (in==NULL) return 0;
+  n = pread(fileno(stream),in,PEEKLENGTH,offset);
+  if (n<=0) {
+    free(in);
+    return 0;
+  }
+
+#ifdef HAVE_ZLIB
+  if (type==COMPRESSION_GZIP) {
+    z_stream z;
+    memset(&z,0,sizeof(z));
+    if (inflateInit2(&z,15+32)==Z_OK) {
+      z.next_in = (Bytef*) in;
+      z.avail_in = n;
+      z.next_out = (Bytef*) buffer;
+      z.avail_out = length;
+      inflate(&z,Z_SYNC_FLUSH);
+      result = length - z.avail_out;
+      inflateEnd(&z);
+    }
+  }
+#endif
+#ifdef HAVE_ZSTD
+  if (type==COMPRESSION_ZSTD) {
+    ZSTD_DStream *z = ZSTD_createDStream();
+    ZSTD_inBuffer input = { in, (size_t) n, 0 };
+    ZSTD_outBuffer output = { buffer, length, 0 };
+    if (z!=NULL) {
+      ZSTD_initDStream(z);
+      while ((output.pos<output.size)&&(input.pos<input.size)) {
+        if (ZSTD_isError(ZSTD_decompressStream(z,&output,&input))) break;
+      }
+      result = output.pos;
+      ZSTD_freeDStream(z);
+    }
+  }
+#endif
+
+  (void) type;
+  (void) buffer;
+  (void) length;
+  free(in);
+  return result;
+}
@@ -0,0 +1,136 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Shared parts of the text readers
+//
+// The readers for GML files, edge lists and Matrix Market files all work
+// the same way.  The file is memory-mapped, or read through a block buffer
+// when it cannot be, and cut into chunks at record boundaries.  Compressed
+// files are read through the block buffer from a decoder thread (see
+// "decoder.h").  Each chunk
+// is parsed on its own thread into node and edge records, and the records
+// of all the chunks are then merged, in file order, into a NETWORK.  This
+// file holds everything but the parsing itself.
+//
+// Function calls:
+//   int read_chunks(NETWORK *network, READER *reader, int nthreads,
+//                   FINDER find_start, void *(*parse)(void*),
+//                   void *context, int merge_ids)
+//     -- Splits the text of "reader" with "find_start", runs "parse" on
+//        each chunk and builds "network" from the records.  If merge_ids
+//        is set, repeated node IDs are merged into one vertex (used by
+//        formats that only list edges).  Returns 0 if successful.
+
+#ifndef LOADER_H
+#define LOADER_H
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include "network.h"
+#include "idmap.h"
+#include "decoder.h"
+
+// Constants
+
+#define BUFFERLENGTH 65536
+#define MINCHUNKLENGTH (1<<22)   // Smallest piece of text worth a thread
+
+// Types
+
+typedef struct {
+  const char *text;    // Text being parsed
+  size_t pos;          // Position of the next unread character in text
+  size_t len;          // Number of valid characters in text
+  FILE *stream;        // Stream the buffer is refilled from, NULL if the
+                       // whole text is in memory
+  char *buffer;        // Block buffer used when the file is not mapped
+  DECODER *decoder;    // Decoder the buffer is refilled from if the file
+                       // is compressed, otherwise NULL
+  void *map;           // Memory mapping of the file, NULL if not mapped
+  size_t maplength;    // Length of the mapping
+} READER;
+
+typedef struct {
+  int directed;        // 1 or 0 if the text says whether the network is
+                       // directed, -1 if it does not
+  int nvertices;       // Number of node records read so far
+  int maxvertices;     // Space allocated for node records
+  int64_t *id;         // ID of each node, in file order
+  long *label;         // Offset in labeltext of the label of each node, -1
+                       // if it has none.  NULL until the first label is seen
+  char *labeltext;     // Labels of the nodes, each NUL-terminated
+  size_t labellength;  // Characters used and allocated in labeltext
+  size_t maxlabellength;
+  int nedges;          // Number of edge records read so far
+  int maxedges;        // Space allocated for edge records
+  int64_t *source;     // IDs of the edge endpoints, in file order, and
+  int64_t *target;     // their vertex indices once resolved
+  double *weight;      // Edge weights.  NULL until the first weight is seen
+  double max_weight;   // Largest and smallest weight seen
+  double min_weight;
+} RECORDS;
+
+typedef struct {
+  READER reader;       // Reader over the part of the text in this chunk
+  RECORDS records;     // Node and edge records found in the chunk
+  NETWORK *network;    // Network the edge records are resolved against
+  const IDMAP *idmap;  // Map of its vertex IDs to vertex indices
+  int *count;          // Edges of each vertex in this chunk, then the next
+                       // slot for them in the edge block.  NULL if the
+                       // chunks are not counted separately
+  void *context;       // Format-specific state shared by all chunks
+  int index;           // Position of the chunk in the file, from 0
+  int result;          // 0 if the chunk was handled successfully
+} CHUNK;
+
+// Function that finds the first record boundary at or after "from"
+typedef size_t (*FINDER)(const char *text, size_t from, size_t length);
+
+// Readers
+
+int open_reader(READER *reader, FILE *stream);
+void close_reader(READER *reader);
+size_t refill(READER *reader);
+void skip_past(READER *reader, int c);
+
+// Records
+
+void init_records(RECORDS *records);
+void free_records(RECORDS *records);
+int add_vertex(RECORDS *records, int64_t id);
+int add_label(RECORDS *records, const char *text, size_t length);
+int add_edge(RECORDS *records, int64_t source, int64_t target, double weight, int has_weight);
+int collect_endpoints(RECORDS *records);
+
+// Chunks
+
+int thread_count(int nthreads);
+size_t find_line(const char *text, size_t from, size_t length);
+int read_chunks(NETWORK *network, READER *reader, int nthreads, FINDER find_start,
+                void *(*parse)(void*), void *context, int merge_ids);
+
+#endif
@@ -5,6 +5,8 @@
 #ifndef _NETWORK_H
 #define _NETWORK_H
 
+#include <stdint.h>
+
 typedef struct {
   int target;        // Index in the vertex[] array of neighboring vertex.
                      // (Note that this is not necessarily equal to the GML
@@ -14,7 +16,7 @@ typedef struct {
 } EDGE;
 
 typedef struct {
-  int id;            // GML ID number of vertex
+  int64_t id;        // GML ID number of vertex
   int degree;        // Degree of vertex (out-degree for directed nets)
   //char *label;       // GML label of vertex.  NULL if no label specified
   EDGE *edge;        // Array of EDGE structs, one for each neighbor
@@ -27,6 +29,13 @@ typedef struct {
   double MAX_Weight; // 1 = unit weight, else otherwise
   double MIN_Weight; // 1 = unit weight, else otherwise
   VERTEX *vertex;    // Array of VERTEX structs, one for each vertex
+  EDGE *edges;       // Single block holding the edge arrays of all the
+                     // vertices, or NULL if each vertex has its own
+  char *labels;      // GML labels of the vertices, each NUL-terminated and
+                     // stored once however many vertices share it.  NULL
+                     // if no vertex has a label
+  long *label;       // Offset in labels[] of the label of each vertex, -1
+                     // if it has none.  NULL if no vertex has a label
 } NETWORK;
 
 #endif
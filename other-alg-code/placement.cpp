@@ -0,0 +1,488 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Placement of the graph arrays on the memory nodes.  See "placement.h".
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <sched.h>
+#include <pthread.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include "placement.h"
+
+#ifdef HAVE_NUMA
+#include <numa.h>
+#include <numaif.h>
+#else
+#define MPOL_BIND 2
+#define MPOL_INTERLEAVE 3
+#define MPOL_MF_MOVE (1<<1)
+#endif
+
+// Constants
+
+#define HUGEPAGE (1<<21)         // Size of a transparent huge page
+#define MAXNODES 1024            // Nodes covered by the masks given to mbind
+
+// How one array is placed
+
+enum { ON_NODE, ON_ALL_NODES, ON_PARTS };
+
+// CPUs the process was allowed to run on before any thread was pinned
+
+static cpu_set_t allowed;
+static pthread_once_t allowed_once = PTHREAD_ONCE_INIT;
+
+
+// Function to turn a policy name into its PLACE_ constant
+
+int placement_policy(const char *name)
+{
+  if (strcmp(name,"local")==0) return PLACE_LOCAL;
+  if (strcmp(name,"interleave")==0) return PLACE_INTERLEAVE;
+  if (strcmp(name,"partition")==0) return PLACE_PARTITION;
+  if (strcmp(name,"replicate")==0) return PLACE_REPLICATE;
+  return -1;
+}
+
+
+// Function to count the memory nodes.  Without libnuma the highest node
+// in the list of online nodes is read from /sys.
+
+int numa_nodes()
+{
+  FILE *stream;
+  int c,n=0,max=0;
+
+#ifdef HAVE_NUMA
+  if (numa_available()>=0) return numa_max_node() + 1;
+#endif
+
+  stream = fopen("/sys/devices/system/node/online","r");
+  if (stream==NULL) return 1;
+  while ((c=getc(stream))!=EOF) {
+    if ((c>='0')&&(c<='9')) {
+      n = 10*n + c - '0';
+      if (n>max) max = n;
+    } else n = 0;
+  }
+  fclose(stream);
+
+  return (max<MAXNODES) ? max + 1 : MAXNODES;
+}
+
+
+// Function to find the node of a CPU, 0 if it cannot be told
+
+int cpu_node(int cpu, int nnodes)
+{
+  int k;
+  char path[64];
+
+#ifdef HAVE_NUMA
+  if (numa_available()>=0) {
+    k = numa_node_of_cpu(cpu);
+    return (k<0) ? 0 : k;
+  }
+#endif
+
+  for (k=0; k<nnodes; k++) {
+    snprintf(path,sizeof(path),"/sys/devices/system/node/node%d/cpu%d",k,cpu);
+    if (access(path,F_OK)==0) return k;
+  }
+  return 0;
+}
+
+
+// Function to set the policy of a range of memory: bound to one node, or
+// interleaved over the first nnodes.  Pages already touched are moved.
+// Failures are ignored, as the policy only affects speed.
+
+void bind_memory(void *start, size_t length, int node, int nnodes, int interleave)
+{
+  int k;
+  unsigned long mask[MAXNODES/(8*sizeof(unsigned long))];
+
+  if (length==0) return;
+  memset(mask,0,sizeof(mask));
+  if (interleave) {
+    for (k=0; k<nnodes; k++) mask[k/(8*sizeof(unsigned long))] |= 1UL << (k%(8*sizeof(unsigned long)));
+  } else mask[node/(8*sizeof(unsigned long))] |= 1UL << (node%(8*sizeof(unsigned long)));
+
+#ifdef HAVE_NUMA
+  mbind(start,length,interleave ? MPOL_INTERLEAVE : MPOL_BIND,mask,MAXNODES+1,MPOL_MF_MOVE);
+#else
+  syscall(SYS_mbind,start,length,interleave ? MPOL_INTERLEAVE : MPOL_BIND,mask,MAXNODES+1,MPOL_MF_MOVE);
+#endif
+}
+
+
+// Function to copy an array into new memory placed in one of the ON_
+// ways: on "node" (no binding if it is negative), interleaved over all
+// the nodes, or with the part from cut[k] to cut[k+1] on node k.  With
+// "array" NULL nothing is copied, and the pages go to their nodes when
+// they are first written.  The new array is aligned to pages, or to huge
+// pages which it is then advised to use.  Returns the new array, or NULL
+// if memory runs out.
+
+void *place_array(const void *array, size_t bytes, int how, int node,
+                  const size_t cut[], int nnodes, int hugepages)
+{
+  int k;
+  size_t page,length,start,end;
+  void *placed;
+
+  page = hugepages ? HUGEPAGE : (size_t) sysconf(_SC_PAGESIZE);
+  length = (bytes + page - 1)/page*page;
+  if (length==0) length = page;
+  if (posix_memalign(&placed,page,length)!=0) return NULL;
+
+  if (hugepages) madvise(placed,length,MADV_HUGEPAGE);
+
+  switch (how) {
+  case ON_NODE:
+    if (node>=0) bind_memory(placed,length,node,nnodes,0);
+    break;
+  case ON_ALL_NODES:
+    bind_memory(placed,length,0,nnodes,1);
+    break;
+  case ON_PARTS:
+    for (k=0; k<nnodes; k++) {
+      start = (k==0) ? 0 : cut[k]/page*page;
+      end = (k==nnodes-1) ? length : cut[k+1]/page*page;
+      if (end>start) bind_memory((char*) placed + start,end-start,k,nnodes,0);
+    }
+    break;
+  }
+
+  // The first touch, by the copy, is what puts the pages on their nodes
+
+  if (array!=NULL) memcpy(placed,array,bytes);
+  return placed;
+}
+
+
+// Function to find the bytes in each array of a graph
+
+void array_sizes(const CSR *graph, size_t size[5])
+{
+  size[0] = ((size_t) graph->nvertices + 1)*sizeof(uint32_t);
+  size[1] = (graph->targets==NULL) ? 0 : ((size_t) graph->nedges + 1)*sizeof(uint32_t);
+  size[2] = (graph->weights==NULL) ? 0 : ((size_t) graph->nedges + 1)*weight_width(graph->weighttype);
+  size[3] = (graph->packed==NULL) ? 0 : (size_t) graph->packedoffsets[graph->nvertices] + 1;
+  size[4] = (graph->packedoffsets==NULL) ? 0 : ((size_t) graph->nvertices + 1)*sizeof(uint64_t);
+}
+
+
+// Function to cut the vertices into one range for each node, with about
+// the same number of edges in each, and find where the part of each array
+// for each range starts.  cut[a][k] is the start of range k in array a,
+// cut[a][nnodes] its end.
+
+void cut_arrays(const CSR *graph, int nnodes, size_t *cut[5])
+{
+  int k;
+  uint32_t u=0;
+  size_t width = weight_width(graph->weighttype);
+
+  for (k=0; k<=nnodes; k++) {
+    while ((u<(uint32_t) graph->nvertices)
+           &&((uint64_t) graph->offsets[u]*nnodes<(uint64_t) graph->nedges*k)) u++;
+    if (k==nnodes) u = graph->nvertices;
+    cut[0][k] = (size_t) u*sizeof(uint32_t);
+    cut[1][k] = (size_t) graph->offsets[u]*sizeof(uint32_t);
+    cut[2][k] = (size_t) graph->offsets[u]*width;
+    cut[3][k] = (graph->packedoffsets==NULL) ? 0 : (size_t) graph->packedoffsets[u];
+    cut[4][k] = (size_t) u*sizeof(uint64_t);
+  }
+}
+
+
+// Function to place all the arrays of a graph into "arrays", in the order
+// offsets, targets, weights, packed, packedoffsets.  Missing arrays stay
+// NULL.  Returns 0 if successful, 1 if memory runs out, in which case
+// nothing is left allocated.
+
+int place_arrays(const CSR *graph, void *arrays[5], int how, int node, int nnodes, int hugepages)
+{
+  int a,k;
+  size_t size[5];
+  size_t *cut[5];
+  const void *source[5] = { graph->offsets, graph->targets, graph->weights,
+                            graph->packed, graph->packedoffsets };
+
+  array_sizes(graph,size);
+  cut[0] = NULL;
+  if (how==ON_PARTS) {
+    cut[0] = (size_t*) malloc(5*(nnodes+1)*sizeof(size_t));
+    if (cut[0]==NULL) return 1;
+    for (a=1; a<5; a++) cut[a] = cut[0] + a*(nnodes+1);
+    cut_arrays(graph,nnodes,cut);
+  }
+
+  for (a=0; a<5; a++) {
+    arrays[a] = NULL;
+    if (source[a]==NULL) continue;
+    arrays[a] = place_array(source[a],size[a],how,node,(how==ON_PARTS) ? cut[a] : NULL,
+                            nnodes,hugepages);
+    if (arrays[a]==NULL) {
+      for (k=0; k<a; k++) free(arrays[k]);
+      free(cut[0]);
+      return 1;
+    }
+  }
+
+  free(cut[0]);
+  return 0;
+}
+
+
+// Function to point a graph at a set of placed arrays
+
+void use_arrays(CSR *graph, void *arrays[5])
+{
+  graph->offsets = (uint32_t*) arrays[0];
+  graph->targets = (uint32_t*) arrays[1];
+  graph->weights = arrays[2];
+  graph->packed = (unsigned char*) arrays[3];
+  graph->packedoffsets = (uint64_t*) arrays[4];
+}
+
+
+// Function to give back the arrays of a graph once they have been copied
+
+void release_arrays(CSR *graph)
+{
+  if (graph->mapping!=NULL) {
+    if (graph->mappinglength>0) munmap(graph->mapping,graph->mappinglength);
+  } else {
+    free(graph->offsets);
+    free(graph->targets);
+    free(graph->weights);
+    free(graph->packed);
+    free(graph->packedoffsets);
+  }
+  graph->mapping = NULL;
+  graph->mappinglength = 0;
+}
+
+
+// Function to place the arrays of a graph
+
+int place_csr(CSR *graph, int policy, int hugepages)
+{
+  int k,nnodes;
+  void *arrays[5];
+  CSR *replicas;
+
+  nnodes = numa_nodes();
+  if ((policy==PLACE_REPLICATE)&&(nnodes==1)) policy = PLACE_LOCAL;
+  if ((policy==PLACE_LOCAL)&&!hugepages) return 0;
+
+  // The in-edges are placed the same way, first
+
+  if ((graph->reverse!=NULL)&&place_csr(graph->reverse,policy,hugepages)) return 1;
+
+  // One copy on each node, each with no copies of its own, and pointing
+  // at the copy of the in-edges on the same node.  The original arrays are
+  // given back, and the graph itself points at those of the copy on node
+  // 0, which free_csr() leaves to the copy.
+
+  if (policy==PLACE_REPLICATE) {
+    replicas = (CSR*) malloc(nnodes*sizeof(CSR));
+    if (replicas==NULL) return 1;
+    for (k=0; k<nnodes; k++) {
+      if (place_arrays(graph,arrays,ON_NODE,k,nnodes,hugepages)) {
+        while (k-->0) free_csr(&replicas[k]);
+        free(replicas);
+        return 1;
+      }
+      replicas[k] = *graph;
+      replicas[k].replicas = NULL;
+      replicas[k].nreplicas = 0;
+      replicas[k].mapping = NULL;
+      replicas[k].mappinglength = 0;
+      replicas[k].reverse = NULL;
+      replicas[k].placement = policy;
+      replicas[k].hugepages = hugepages;
+      use_arrays(&replicas[k],arrays);
+    }
+    for (k=0; k<nnodes; k++)
+      if (graph->reverse!=NULL) replicas[k].reverse = &graph->reverse->replicas[k];
+    release_arrays(graph);
+    graph->offsets = replicas[0].offsets;
+    graph->targets = replicas[0].targets;
+    graph->weights = replicas[0].weights;
+    graph->packed = replicas[0].packed;
+    graph->packedoffsets = replicas[0].packedoffsets;
+    graph->replicas = replicas;
+    graph->nreplicas = nnodes;
+    graph->placement = policy;
+    graph->hugepages = hugepages;
+    return 0;
+  }
+
+  // Otherwise the arrays of the graph itself are replaced
+
+  switch (policy) {
+  case PLACE_INTERLEAVE: k = place_arrays(graph,arrays,ON_ALL_NODES,0,nnodes,hugepages); break;
+  case PLACE_PARTITION: k = place_arrays(graph,arrays,ON_PARTS,0,nnodes,hugepages); break;
+  default: k = place_arrays(graph,arrays,ON_NODE,-1,nnodes,hugepages);
+  }
+  if (k) return 1;
+
+  release_arrays(graph);
+  graph->placement = policy;
+  graph->hugepages = hugepages;
+  use_arrays(graph,arrays);
+
+  return 0;
+}
+
+
+// Function to allocate the state of the calling thread.  It is bound to
+// the node the thread runs on when it asks, which is where an unpinned
+// thread keeps it even if it is later moved.
+
+void *place_state(const CSR *graph, size_t bytes)
+{
+  int cpu,node,nnodes;
+  void *state;
+
+  if ((graph->placement==PLACE_LOCAL)&&!graph->hugepages) return calloc(bytes>0 ? bytes : 1,1);
+
+  nnodes = numa_nodes();
+  cpu = sched_getcpu();
+  node = ((cpu<0)||(nnodes==1)) ? -1 : cpu_node(cpu,nnodes);
+  state = place_array(NULL,bytes,ON_NODE,node,NULL,nnodes,graph->hugepages);
+  if (state!=NULL) memset(state,0,bytes);
+  return state;
+}
+
+
+// Function to allocate an array over the edges of a graph, placed as its
+// targets are
+
+int place_edges(const CSR *graph, size_t width, void *copies[])
+{
+  int a,k,nnodes;
+  size_t bytes = ((size_t) graph->nedges + 1)*width;
+  size_t *cut[5];
+
+  nnodes = numa_nodes();
+
+  if (graph->replicas!=NULL) {
+    for (k=0; k<graph->nreplicas; k++) {
+      copies[k] = place_array(NULL,bytes,ON_NODE,k,NULL,nnodes,graph->hugepages);
+      if (copies[k]==NULL) {
+        while (k-->0) free(copies[k]);
+        return 1;
+      }
+    }
+    return 0;
+  }
+
+  switch (graph->placement) {
+  case PLACE_INTERLEAVE:
+    copies[0] = place_array(NULL,bytes,ON_ALL_NODES,0,NULL,nnodes,graph->hugepages);
+    break;
+  case PLACE_PARTITION:
+    cut[0] = (size_t*) malloc(5*(nnodes+1)*sizeof(size_t));
+    if (cut[0]==NULL) return 1;
+    for (a=1; a<5; a++) cut[a] = cut[0] + a*(nnodes+1);
+    cut_arrays(graph,nnodes,cut);
+    for (k=0; k<=nnodes; k++) cut[1][k] = cut[1][k]/sizeof(uint32_t)*width;
+    copies[0] = place_array(NULL,bytes,ON_PARTS,0,cut[1],nnodes,graph->hugepages);
+    free(cut[0]);
+    break;
+  default:
+    if (graph->hugepages) copies[0] = place_array(NULL,bytes,ON_NODE,-1,NULL,nnodes,1);
+    else copies[0] = malloc(bytes);
+  }
+  return (copies[0]==NULL);
+}
+
+
+// Function to find the copy of a graph on the node of the calling thread
+
+CSR *local_csr(CSR *graph)
+{
+  int cpu,node;
+
+  if (graph->replicas==NULL) return graph;
+  cpu = sched_getcpu();
+  node = (cpu<0) ? 0 : cpu_node(cpu,graph->nreplicas);
+  if (node>=graph->nreplicas) node = 0;
+  return &graph->replicas[node];
+}
+
+
+// Function to record the CPUs the process may run on, before any thread
+// is pinned and narrows the set inherited by the threads it starts
+
+void read_allowed()
+{
+  CPU_ZERO(&allowed);
+  if (sched_getaffinity(0,sizeof(allowed),&allowed)!=0) CPU_ZERO(&allowed);
+}
+
+
+// Function to pin the calling thread to one CPU.  Thread "index" goes to
+// node index%nnodes, or the next node that has allowed CPUs, and to the
+// (index/nnodes)-th allowed CPU of that node, wrapping around.
+
+int pin_thread(int index)
+{
+  int cpu,k,node,nnodes,count,pick;
+  cpu_set_t one;
+
+  pthread_once(&allowed_once,read_allowed);
+  if (CPU_COUNT(&allowed)==0) return 1;
+  nnodes = numa_nodes();
+
+  for (k=0; k<nnodes; k++) {
+    node = (index + k)%nnodes;
+    count = 0;
+    for (cpu=0; cpu<CPU_SETSIZE; cpu++)
+      if (CPU_ISSET(cpu,&allowed)&&(cpu_node(cpu,nnodes)==node)) count++;
+    if (count==0) continue;
+
+    pick = (index/nnodes)%count;
+    for (cpu=0; cpu<CPU_SETSIZE; cpu++) {
+      if (!CPU_ISSET(cpu,&allowed)||(cpu_node(cpu,nnodes)!=node)) continue;
+      if (pick--==0) {
+        CPU_ZERO(&one);
+        CPU_SET(cpu,&one);
+        return (sched_setaffinity(0,sizeof(one),&one)!=0);
+      }
+    }
+  }
+
+  return 1;
+}
@@ -0,0 +1,304 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Readers for edge lists and Matrix Market files.  See "readedges.h".
+//
+// Both formats hold one edge per line, so the text is cut into chunks at
+// line starts and each chunk is parsed on its own thread with the machinery
+// of "loader.h".  Edge lists have no node records: every chunk collects the
+// distinct endpoints of its own edges, and the vertex IDs are merged when
+// the network is built.  Matrix Market files give the number of vertices in
+// their size line, which is read before the text is split.
+
+
+// Inclusions
+
+#include "readedges.h"
+#include "loader.h"
+#include "bytescan.h"
+
+// Types
+
+typedef struct {
+  int directed;        // Whether an edge list is directed when it does not
+                       // say so itself
+  int nvertices;       // Matrix size of a Matrix Market file
+  int weighted;        // Whether Matrix Market entries carry a value
+} EDGEFORMAT;
+
+
+// Function to find the next line of the text, refilling the buffer so that
+// the whole line is in it.  The line runs from *start up to but not
+// including *stop, which is its newline or the end of the text.  Returns 0
+// at the end of the text, otherwise 1.
+
+int next_line(READER *reader, const char **start, const char **stop)
+{
+  const char *p,*end;
+
+  while (1) {
+    p = reader->text + reader->pos;
+    end = reader->text + reader->len;
+    if (p==end) {
+      if (refill(reader)==0) return 0;
+      continue;
+    }
+    *stop = scan_char(p,end,'\n');
+    if ((*stop<end)||(refill(reader)==0)) break;
+  }
+  p = reader->text + reader->pos;
+  *start = p;
+  reader->pos = *stop - reader->text;
+  if (reader->pos<reader->len) reader->pos++;
+
+  return 1;
+}
+
+
+// Function to read one field of a line into [*field,*fieldend).  Returns 0
+// if there are no more fields, because the line ends or a comment starts.
+
+int next_field(const char **p, const char *stop, const char **field, const char **fieldend)
+{
+  const char *q;
+
+  q = scan_space(*p,stop);
+  if ((q==stop)||(*q=='#')||(*q=='%')) return 0;
+  *field = q;
+  *fieldend = *p = scan_delim(q,stop);
+  return 1;
+}
+
+
+// Function to look for a SNAP header in a comment line, which says whether
+// the network is directed
+
+void read_comment(const char *p, const char *stop, RECORDS *records)
+{
+  size_t n = stop - p;
+
+  if (memmem(p,n,"Undirected graph",16)!=NULL) records->directed = 0;
+  else if (memmem(p,n,"Directed graph",14)!=NULL) records->directed = 1;
+}
+
+
+// Function to read the edge lines of one chunk.  "weighted" is -1 when an
+// optional third field is a weight, 1 when it must be there and 0 when it
+// must not.  Returns 1 on a malformed line or if memory runs out,
+// otherwise 0.
+
+int read_edge_lines(READER *reader, RECORDS *records, int weighted)
+{
+  const char *p,*start,*stop;
+  const char *field,*fieldend;
+  long s,t;
+  double w=1.0;
+  int has_w;
+
+  while (next_line(reader,&start,&stop)) {
+    p = scan_space(start,stop);
+    if (p==stop) continue;
+    if ((*p=='#')||(*p=='%')) {
+      read_comment(p,stop,records);
+      continue;
+    }
+
+    if (!next_field(&p,stop,&field,&fieldend)||parse_int(field,fieldend,&s)) return 1;
+    if (!next_field(&p,stop,&field,&fieldend)||parse_int(field,fieldend,&t)) return 1;
+    has_w = next_field(&p,stop,&field,&fieldend);
+    if (has_w) {
+      if ((weighted==0)||parse_double(field,fieldend,&w)) return 1;
+    } else if (weighted==1) return 1;
+
+    if (add_edge(records,s,t,w,has_w)) return 1;
+  }
+
+  return 0;
+}
+
+
+// Thread function to read the edges of one chunk of an edge list
+
+void *parse_edgelist_chunk(void *arg)
+{
+  CHUNK *chunk = (CHUNK*) arg;
+  EDGEFORMAT *format = (EDGEFORMAT*) chunk->context;
+
+  chunk->result = read_edge_lines(&chunk->reader,&chunk->records,-1);
+  if (chunk->result==0) chunk->result = collect_endpoints(&chunk->records);
+
+  // A header in any chunk decides; otherwise the caller's default holds
+
+  if ((chunk->index==0)&&(chunk->records.directed<0))
+    chunk->records.directed = format->directed;
+
+  return NULL;
+}
+
+
+// Function to read a complete edge list
+
+int read_edgelist(NETWORK *network, FILE *stream, int directed, int nthreads)
+{
+  int result;
+  READER reader;
+  EDGEFORMAT format;
+
+  network->nvertices = 0;
+  network->vertex = NULL;
+  network->edges = NULL;
+  network->labels = NULL;
+  network->label = NULL;
+
+  format.directed = directed;
+  format.nvertices = 0;
+  format.weighted = -1;
+
+  if (open_reader(&reader,stream)) return 1;
+  result = read_chunks(network,&reader,nthreads,find_line,parse_edgelist_chunk,&format,1);
+  close_reader(&reader);
+
+  return result;
+}
+
+
+// Function to check whether the field [p,q) equals a given word, ignoring
+// case as the Matrix Market format does
+
+int is_word(const char *p, const char *q, const char *word)
+{
+  size_t n = strlen(word);
+  return ((size_t) (q-p)==n)&&(strncasecmp(p,word,n)==0);
+}
+
+
+// Function to read the banner, comments and size line of a Matrix Market
+// file.  Only real, integer and pattern matrices in coordinate form are
+// understood, either general (directed) or symmetric (undirected).
+// Returns 1 if the header is not understood, otherwise 0.
+
+int read_mtx_header(READER *reader, EDGEFORMAT *format)
+{
+  int i;
+  long size[3];
+  const char *p,*start,*stop;
+  const char *field[5],*fieldend[5];
+
+  // Banner: %%MatrixMarket matrix coordinate <field> <symmetry>
+
+  if (!next_line(reader,&start,&stop)) return 1;
+  if (((size_t) (stop-start)<14)||(memcmp(start,"%%MatrixMarket",14)!=0)) return 1;
+  p = start + 14;
+  for (i=0; i<4; i++) {
+    field[i] = scan_space(p,stop);
+    if (field[i]==stop) return 1;
+    fieldend[i] = p = scan_delim(field[i],stop);
+  }
+  if (!is_word(field[0],fieldend[0],"matrix")||!is_word(field[1],fieldend[1],"coordinate"))
+    return 1;
+
+  if (is_word(field[2],fieldend[2],"pattern")) format->weighted = 0;
+  else if (is_word(field[2],fieldend[2],"real")||is_word(field[2],fieldend[2],"integer"))
+    format->weighted = 1;
+  else return 1;
+
+  if (is_word(field[3],fieldend[3],"general")) format->directed = 1;
+  else if (is_word(field[3],fieldend[3],"symmetric")) format->directed = 0;
+  else return 1;
+
+  // Comments, then the size line: rows columns entries
+
+  do {
+    if (!next_line(reader,&start,&stop)) return 1;
+    p = scan_space(start,stop);
+  } while ((p==stop)||(*p=='%'));
+
+  p = start;
+  for (i=0; i<3; i++) {
+    if (!next_field(&p,stop,&field[i],&fieldend[i])) return 1;
+    if (parse_int(field[i],fieldend[i],&size[i])||(size[i]<0)) return 1;
+  }
+  format->nvertices = (int) ((size[0]>size[1]) ? size[0] : size[1]);
+
+  return 0;
+}
+
+
+// Thread function to read the entries of one chunk of a Matrix Market file.
+// The first chunk also creates the vertices, numbered from 1.
+
+void *parse_mtx_chunk(void *arg)
+{
+  int i;
+  CHUNK *chunk = (CHUNK*) arg;
+  EDGEFORMAT *format = (EDGEFORMAT*) chunk->context;
+
+  chunk->records.directed = format->directed;
+  if (chunk->index==0) {
+    for (i=1; i<=format->nvertices; i++) {
+      if (add_vertex(&chunk->records,i)) {
+        chunk->result = 1;
+        return NULL;
+      }
+    }
+  }
+  chunk->result = read_edge_lines(&chunk->reader,&chunk->records,format->weighted);
+
+  return NULL;
+}
+
+
+// Function to read a complete Matrix Market file
+
+int read_matrixmarket(NETWORK *network, FILE *stream, int nthreads)
+{
+  int result;
+  READER reader;
+  EDGEFORMAT format;
+
+  network->nvertices = 0;
+  network->vertex = NULL;
+  network->edges = NULL;
+  network->labels = NULL;
+  network->label = NULL;
+
+  if (open_reader(&reader,stream)) return 1;
+  result = read_mtx_header(&reader,&format);
+
+  // Only the entries are split between the threads
+
+  if (result==0) {
+    if (reader.stream==NULL) {
+      reader.text += reader.pos;
+      reader.len -= reader.pos;
+      reader.pos = 0;
+    }
+    result = read_chunks(network,&reader,nthreads,find_line,parse_mtx_chunk,&format,0);
+  }
+  close_reader(&reader);
+
+  return result;
+}
@@ -10,413 +10,309 @@
 //     -- Reads a network from the FILE pointed to by "stream" into the
 //        structure "network".  For the format of NETWORK structs see file
 //        "network.h".  Returns 0 if read was successful.
+//   int read_network_threads(NETWORK *network, FILE *stream, int nthreads)
+//     -- The same, using at most "nthreads" parser threads (0 means one
+//        per online processor, which is what read_network uses)
 //   void free_network(NETWORK *network)
 //     -- Destroys a NETWORK struct again, freeing up the memory
+//   void free_edges(NETWORK *network)
+//     -- Frees the edges of a network but keeps its vertices, with their
+//        ids, degrees and labels, e.g. once its CSR form is built
+//   const char *vertex_label(NETWORK *network, int i)
+//     -- Returns the GML label of vertex i, or NULL if it has none
+//
+// The file is read in a single pass.  When the stream is a regular file it
+// is memory-mapped and tokenized in place; otherwise (pipes, terminals) the
+// text is pulled through a fixed-size block buffer.  Tokens are pointers
+// into the text, found with the vectorized scans of "bytescan.h", and
+// numbers are parsed where they lie.  The id of every node and the
+// endpoints and weight of every edge are recorded as they are met, and the
+// vertex and edge arrays are then built from these records, so the memory
+// needed is set by the size of the network and not by the size of the text.
+//
+// Large mapped files are cut into chunks at the start of node and edge
+// records, and each chunk is parsed and resolved on its own thread.  The
+// chunks are merged in file order, so the network is the same whatever
+// the number of threads.  A chunk boundary is only placed at a line that
+// begins with "node [" or "edge [", so files written with several records
+// on one line are simply parsed in fewer chunks.
 
 
 // Inclusions
 
 #include "readgml.h"
+#include "loader.h"
+#include "bytescan.h"
 
-// Constants
+// Token types returned by next_token()
 
-#define LINELENGTH 1000
+enum { TOKEN_END, TOKEN_KEY, TOKEN_VALUE, TOKEN_STRING, TOKEN_OPEN, TOKEN_CLOSE };
 
 // Types
 
-typedef struct line {
-  char *str;
-  struct line *ptr;
-} LINE;
-
-// Globals
-
-LINE *first;
-LINE *current;
-
-
-// Function to read one line from a specified stream.  Return value is
-// 1 if an EOF was encountered.  Otherwise 0.
-
-int read_line(FILE *stream, char line[LINELENGTH])
-{
-  if (fgets(line,LINELENGTH,stream)==NULL) return 1;
-  line[strlen(line)-1] = '\0';   // Erase the terminating NEWLINE
-  return 0;
-}
+typedef struct {
+  int type;            // One of the TOKEN_ types
+  const char *str;     // Start of a key, bare value or string contents in
+                       // the reader's text.  Only valid until the next
+                       // call to next_token()
+  size_t len;          // Length of the key, value or string
+} TOKEN;
 
 
-// Function to read in the whole file into a linked-list buffer, so that we
-// can do several passes on it, as required to read the GML format
-// efficiently
+// Function to read the next token of the GML file.  Keys, bare values
+// (numbers) and the contents of quoted strings are returned as pointers
+// into the text.  Returns the token type.
 
-int fill_buffer(FILE *stream)
+int next_token(READER *reader, TOKEN *token)
 {
-  int length;
-  char line[LINELENGTH];
-  LINE *previous;
-
-  if (read_line(stream,line)!=0) {
-    first = NULL;                // Indicates empty buffer
-    return 1;
+  const char *p,*q,*end;
+
+  // Skip white space and comment lines
+
+  while (1) {
+    p = reader->text + reader->pos;
+    end = reader->text + reader->len;
+    p = scan_space(p,end);
+    reader->pos = p - reader->text;
+    if (p==end) {
+      if (refill(reader)==0) return token->type = TOKEN_END;
+    } else if (*p=='#') {
+      skip_past(reader,'\n');
+    } else break;
   }
-  length = strlen(line) + 1;
-  first = (LINE*) malloc(sizeof(LINE));
-  first->str = (char*) malloc(length*sizeof(char));
-  strcpy(first->str,line);
-
-  previous = first;
-  while (read_line(stream,line)==0) {
-    length = strlen(line) + 1;
-    previous->ptr = (LINE*) malloc(sizeof(LINE));
-    previous = previous->ptr;
-    previous->str = (char*) malloc(length*sizeof(char));
-    strcpy(previous->str,line);
-  }
-  previous->ptr = NULL;          // Indicates last line
 
-  return 0;
-}
+  // Brackets are tokens on their own
 
+  if ((*p=='[')||(*p==']')) {
+    reader->pos++;
+    return token->type = (*p=='[') ? TOKEN_OPEN : TOKEN_CLOSE;
+  }
 
-// Function to free up the buffer again
+  // Quoted strings run to the next double quote.  A string that does not
+  // fit in the block buffer is skipped and returned empty.
 
-void free_buffer()
-{
-  LINE *thisptr;
-  LINE *nextptr;
-
-  thisptr = first;
-  while (thisptr!=NULL) {
-    nextptr = thisptr->ptr;
-    free(thisptr->str);
-    free(thisptr);
-    thisptr = nextptr;
+  if (*p=='"') {
+    reader->pos++;
+    while (1) {
+      p = reader->text + reader->pos;
+      end = reader->text + reader->len;
+      q = scan_char(p,end,'"');
+      if ((q<end)||(refill(reader)==0)) break;
+    }
+    token->str = p;
+    token->len = q - p;
+    reader->pos = q - reader->text;
+    if (q<end) reader->pos++;
+    else if (reader->stream!=NULL) {
+      token->len = 0;
+      skip_past(reader,'"');
+    }
+    return token->type = TOKEN_STRING;
   }
-}
 
+  // Anything else runs to the next white space or bracket.  If it runs to
+  // the end of the buffer, refill and look again.
 
-// Function to reset to the start of the buffer again
+  while (1) {
+    q = scan_delim(p,end);
+    if ((q<end)||(refill(reader)==0)) break;
+    p = reader->text + reader->pos;
+    end = reader->text + reader->len;
+  }
+  token->str = p;
+  token->len = q - p;
+  reader->pos = q - reader->text;
 
-void reset_buffer()
-{
-  current = first;
+  if (((*p>='a')&&(*p<='z'))||((*p>='A')&&(*p<='Z'))||(*p=='_'))
+    return token->type = TOKEN_KEY;
+  return token->type = TOKEN_VALUE;
 }
 
 
-// Function to get the next line in the buffer.  Returns 0 if there was
-// a line or 1 if we've reached the end of the buffer.
+// Function to compare a key token with a given key name
 
-int next_line(char line[LINELENGTH])
+int is_key(TOKEN *token, const char *key, size_t length)
 {
-  if (current==NULL) return 1;
-  strcpy(line,current->str);
-  current = current->ptr;
-  return 0;
+  return (token->len==length)&&(memcmp(token->str,key,length)==0);
 }
 
 
+// Function to read the value that follows a key.  Bare values are left in
+// "token"; lists are skipped over up to their closing bracket, including
+// any nested lists.  Returns the token type of the value, or TOKEN_END if
+// the end of the stream was reached first.
 
-// Function to establish whether the network read from a given stream is
-// directed or not.  Returns 1 for a directed network, and 0 otherwise.  If
-// the GML file contains no "directed" line then the graph is assumed to be
-// undirected, which is the GML default behavior.
-
-int is_directed()
+int read_value(READER *reader, TOKEN *token)
 {
-  int result=0;
-  char *ptr;
-  char line[LINELENGTH];
+  int depth;
 
-  reset_buffer();
+  if (next_token(reader,token)!=TOKEN_OPEN) return token->type;
 
-  while (next_line(line)==0) {
-    ptr = strstr(line,"directed");
-    if (ptr==NULL) continue;
-    sscanf(ptr,"directed %i",&result);
-    break;
+  depth = 1;
+  while (depth>0) {
+    switch (next_token(reader,token)) {
+    case TOKEN_END: return TOKEN_END;
+    case TOKEN_OPEN: depth++; break;
+    case TOKEN_CLOSE: depth--; break;
+    }
   }
 
-  return result;
+  return token->type = TOKEN_OPEN;
 }
 
 
-// Function to count the vertices in a GML file.  Returns number of vertices.
+// Function to read the body of a "node" list, after its opening bracket.
+// The node record is made first, so that its label can be stored as soon
+// as it is met.  Returns 1 on failure, otherwise 0.
 
-int count_vertices()
+int read_node(READER *reader, RECORDS *records)
 {
-  int result=0;
-  char *ptr;
-  char line[LINELENGTH];
-
-  reset_buffer();
-
-  while (next_line(line)==0) {
-    ptr = strstr(line,"node");
-    if (ptr!=NULL) result++;
+  int type;
+  long id=0;
+  TOKEN token;
+
+  if (add_vertex(records,0)) return 1;
+
+  while ((type=next_token(reader,&token))!=TOKEN_END) {
+    if (type==TOKEN_CLOSE) break;
+    if (type!=TOKEN_KEY) continue;
+    if (is_key(&token,"id",2)) {
+      type = read_value(reader,&token);
+      if ((type==TOKEN_VALUE)&&!parse_int(token.str,token.str+token.len,&id))
+        records->id[records->nvertices-1] = id;
+    } else if (is_key(&token,"label",5)) {
+      type = read_value(reader,&token);
+      if ((type==TOKEN_STRING)&&add_label(records,token.str,token.len)) return 1;
+    } else type = read_value(reader,&token);
+    if (type==TOKEN_END) break;
   }
 
-  return result;
-}
-
-
-// Function to compare the IDs of two vertices
-
-int cmpid(const void *v1p, const void *v2p)
-{
-  VERTEX *v1 = (VERTEX*) v1p;
-  VERTEX *v2 = (VERTEX*) v2p;
-  if (v1->id>v2->id) return 1;
-  if (v1->id<v2->id) return -1;
   return 0;
 }
 
 
-// Function to allocate space for a network structure stored in a GML file
-// and determine the parameters (id, label) of each of the vertices.
+// Function to read the body of an "edge" list, after its opening bracket.
+// Edges that lack a source or a target are ignored.  Returns 1 on failure,
+// otherwise 0.
 
-void create_network(NETWORK *network)
+int read_edge(READER *reader, RECORDS *records)
 {
-  int i;
-  //int length;
-  char *ptr;
-  //char *start,*stop;
-  char line[LINELENGTH];
-  //char label[LINELENGTH];
-
-  // Set MAX and MIN weight as 1
-
-  network->MAX_Weight = 1;
-  network->MIN_Weight = 1;
-
-  //Set number of edges as 0
-
-  network->nedges = 0;
-
-  // Determine whether the network is directed
-
-  network->directed = is_directed();
-
-  // Count the vertices
-
-  network->nvertices = count_vertices();
-
-  // Make space for the vertices
-
-  network->vertex = (VERTEX*) calloc(network->nvertices,sizeof(VERTEX));
-
-  // Go through the file reading the details of each vertex one by one
-
-  reset_buffer();
-  for (i=0; i<network->nvertices; i++) {
-
-    // Skip to next "node" entry
-
-    do {
-      next_line(line);
-    } while (strstr(line,"node")==NULL);
-
-    // Read in the details of this vertex
-
-    do {
-
-      // Look for ID
-
-      ptr = strstr(line,"id");
-      if (ptr!=NULL) sscanf(ptr,"id %i",&network->vertex[i].id);
-
-      // Look for label
-
-      /*ptr = (strstr(line,"label"));
-      if (ptr!=NULL) {
-	start = strchr(line,'"');
-	if (start==NULL) {
-	  sscanf(ptr,"label %s",&label);
-	} else {
-	  stop = strchr(++start,'"');
-	  if (stop==NULL) length = strlen(line) - (start-line);
-	  else length = stop - start;
-	  strncpy(label,start,length);
-	  label[length] = '\0';
-	  network->vertex[i].label = (char*) malloc((length+1)*sizeof(char));
-	  strcpy(network->vertex[i].label,label);
-	}
-      }*/
-
-      // If we see a closing square bracket we are done
-
-      if (strstr(line,"]")!=NULL) break;
-
-    } while (next_line(line)==0);
-
+  int type;
+  int has_s=0,has_t=0,has_w=0;
+  long s=0,t=0;
+  double w=1.0;
+  TOKEN token;
+
+  while ((type=next_token(reader,&token))!=TOKEN_END) {
+    if (type==TOKEN_CLOSE) break;
+    if (type!=TOKEN_KEY) continue;
+    if (is_key(&token,"source",6)) {
+      type = read_value(reader,&token);
+      if (type==TOKEN_VALUE) has_s = !parse_int(token.str,token.str+token.len,&s);
+    } else if (is_key(&token,"target",6)) {
+      type = read_value(reader,&token);
+      if (type==TOKEN_VALUE) has_t = !parse_int(token.str,token.str+token.len,&t);
+    } else if (is_key(&token,"value",5)) {
+      type = read_value(reader,&token);
+      if (type==TOKEN_VALUE) has_w = !parse_double(token.str,token.str+token.len,&w);
+    } else type = read_value(reader,&token);
+    if (type==TOKEN_END) break;
   }
 
-  // Sort the vertices in increasing order of their IDs so we can find them
-  // quickly later
+  if ((has_s==0)||(has_t==0)) return 0;
 
-  qsort(network->vertex,network->nvertices,sizeof(VERTEX),cmpid); //(void*)cmpid);
+  return add_edge(records,s,t,w,has_w);
 }
 
 
-// Function to find a vertex with a specified ID using binary search.
-// Returns the element in the vertex[] array holding the vertex in question,
-// or -1 if no vertex was found.
-
-int find_vertex(int id, NETWORK *network)
-{
-  int top,bottom,split;
-  int idsplit;
-
-  top = network->nvertices;
-  if (top<1) return -1;
-  bottom = 0;
-  split = top/2;
-
-  do {
-    idsplit = network->vertex[split].id;
-    if (id>idsplit) {
-      bottom = split + 1;
-      split = (top+bottom)/2;
-    } else if (id<idsplit) {
-      top = split;
-      split = (top+bottom)/2;
-    } else return split;
-  } while (top>bottom);
-
-  return -1;
-}
-    
-
-// Function to determine the degrees of all the vertices by going through
-// the edge data
+// Function to read the node and edge records from the whole stream in one
+// pass.  The enclosing "graph" list is transparent: its keys are handled
+// the same way as keys at the top level.  Returns 1 on failure, otherwise 0.
 
-void get_degrees(NETWORK *network)
+int read_records(READER *reader, RECORDS *records)
 {
-  int s,t;
-  int vs,vt;
-  char *ptr;
-  char line[LINELENGTH];
-
-  reset_buffer();
-
-  while (next_line(line)==0) {
-
-    // Find the next edge entry
-
-    ptr = strstr(line,"edge");
-    if (ptr==NULL) continue;
-
-    // Read the source and target of the edge
-
-    s = t = -1;
-
-    do {
-
-      ptr = strstr(line,"source");
-      if (ptr!=NULL) sscanf(ptr,"source %i",&s);
-      ptr = strstr(line,"target");
-      if (ptr!=NULL) sscanf(ptr,"target %i",&t);
-
-      // If we see a closing square bracket we are done
-
-      if (strstr(line,"]")!=NULL) break;
-
-    } while (next_line(line)==0);
-
-    // Increment the degrees of the appropriate vertex or vertices
-
-    if ((s>=0)&&(t>=0)) {
-		vs = find_vertex(s,network);
-		network->vertex[vs].degree++;
-		network->nedges++;
-		if (network->directed==0) {
-			vt = find_vertex(t,network);
-			network->vertex[vt].degree++;
-		}
-	}
-
+  int type;
+  long directed;
+  TOKEN token;
+
+  while ((type=next_token(reader,&token))!=TOKEN_END) {
+    if (type!=TOKEN_KEY) continue;
+
+    if (is_key(&token,"node",4)) {
+      type = next_token(reader,&token);
+      if ((type==TOKEN_OPEN)&&read_node(reader,records)) return 1;
+    } else if (is_key(&token,"edge",4)) {
+      type = next_token(reader,&token);
+      if ((type==TOKEN_OPEN)&&read_edge(reader,records)) return 1;
+    } else if (is_key(&token,"graph",5)) {
+      type = next_token(reader,&token);
+    } else if (is_key(&token,"directed",8)) {
+      type = read_value(reader,&token);
+      if ((type==TOKEN_VALUE)&&!parse_int(token.str,token.str+token.len,&directed))
+        records->directed = (int) directed;
+    } else type = read_value(reader,&token);
+    if (type==TOKEN_END) break;
   }
 
-  return;
+  return 0;
 }
 
 
-// Function to read in the edges
+// Function to find the first node or edge record that starts a line at or
+// after position "from" in the text.  Returns the position of its key, or
+// the length of the text if there is none.
 
-void read_edges(NETWORK *network)
+size_t find_record(const char *text, size_t from, size_t length)
 {
-  int i;
-  int s,t;
-  int vs,vt;
-  int *count;
-  double w;
-  char *ptr;
-  char line[LINELENGTH];
-
-  // Malloc space for the edges and temporary space for the edge counts
-  // at each vertex
-
-  for (i=0; i<network->nvertices; i++) {
-    network->vertex[i].edge = (EDGE*) malloc(network->vertex[i].degree*sizeof(EDGE));
+  const char *p,*q,*end;
+
+  p = text + from;
+  end = text + length;
+  while (1) {
+    p = scan_char(p,end,'\n');
+    if (p==end) return length;
+    q = ++p;
+    while ((q<end)&&((*q==' ')||(*q=='\t'))) q++;
+    if ((end-q>4)&&((memcmp(q,"node",4)==0)||(memcmp(q,"edge",4)==0))
+        &&is_delim((unsigned char) q[4])) {
+      p = scan_space(q+4,end);
+      if ((p<end)&&(*p=='[')) return q - text;
+    }
   }
-  count = (int*) calloc(network->nvertices,sizeof(int));
-
-  // Read in the data
-
-  reset_buffer();
-
-  while (next_line(line)==0) {
-
-    // Find the next edge entry
-
-    ptr = strstr(line,"edge");
-    if (ptr==NULL) continue;
-
-    // Read the source and target of the edge and the edge weight
+}
 
-    s = t = -1;
-    w = 1.0;
 
-    do {
+// Thread function to read the node and edge records of one chunk
 
-      ptr = strstr(line,"source");
-      if (ptr!=NULL) sscanf(ptr,"source %i",&s);
-      ptr = strstr(line,"target");
-      if (ptr!=NULL) sscanf(ptr,"target %i",&t);
-      ptr = strstr(line,"value");
-	  if (ptr!=NULL) {
-        sscanf(ptr,"value %lf",&w);
-		if (network->MAX_Weight < w )
-			network->MAX_Weight = w;
-		if (network->MIN_Weight > w )
-			network->MIN_Weight = w;
-	  }
+void *parse_chunk(void *arg)
+{
+  CHUNK *chunk = (CHUNK*) arg;
 
-      // If we see a closing square bracket we are done
+  chunk->result = read_records(&chunk->reader,&chunk->records);
+  return NULL;
+}
 
-      if (strstr(line,"]")!=NULL) break;
 
-    } while (next_line(line)==0);
+// Function to read a complete network, using up to "nthreads" threads to
+// parse a mapped file.  If nthreads is 0 or less, one thread per online
+// processor is used.
 
-    // Add these edges to the appropriate vertices
+int read_network_threads(NETWORK *network, FILE *stream, int nthreads)
+{
+  int result;
+  READER reader;
 
-    if ((s>=0)&&(t>=0)) {
-      vs = find_vertex(s,network);
-      vt = find_vertex(t,network);
-      network->vertex[vs].edge[count[vs]].target = vt;
-      network->vertex[vs].edge[count[vs]].weight = w;
-      count[vs]++;
-      if (network->directed==0) {
-	network->vertex[vt].edge[count[vt]].target = vs;
-	network->vertex[vt].edge[count[vt]].weight = w;
-	count[vt]++;
-      }
-    }
+  network->nvertices = 0;
+  network->vertex = NULL;
+  network->edges = NULL;
+  network->labels = NULL;
+  network->label = NULL;
 
-  }
+  if (open_reader(&reader,stream)) return 1;
+  result = read_chunks(network,&reader,nthreads,find_record,parse_chunk,NULL,0);
+  close_reader(&reader);
 
-  free(count);
-  return;
+  return result;
 }
 
 
@@ -424,13 +320,7 @@ void read_edges(NETWORK *network)
 
 int read_network(NETWORK *network, FILE *stream)
 {
-  fill_buffer(stream);
-  create_network(network);
-  get_degrees(network);
-  read_edges(network);
-  free_buffer();
-
-  return 0;
+  return read_network_threads(network,stream,0);
 }
 
 
@@ -440,10 +330,41 @@ void free_network(NETWORK *network)
 {
   int i;
 
-  for (i=0; i<network->nvertices; i++) {
-    free(network->vertex[i].edge);
-    //free(network->vertex[i].label);
+  if (network->vertex==NULL) return;
+  if (network->edges==NULL) {
+    for (i=0; i<network->nvertices; i++) free(network->vertex[i].edge);
   }
+  free(network->edges);
   free(network->vertex);
+  free(network->labels);
+  free(network->label);
+  network->vertex = NULL;
+  network->edges = NULL;
+  network->labels = NULL;
+  network->label = NULL;
+}
+
+
+// Function to free the edges of a network but keep its vertices
+
+void free_edges(NETWORK *network)
+{
+  int i;
+
+  if (network->vertex==NULL) return;
+  for (i=0; i<network->nvertices; i++) {
+    if (network->edges==NULL) free(network->vertex[i].edge);
+    network->vertex[i].edge = NULL;
+  }
+  free(network->edges);
+  network->edges = NULL;
 }
 
+
+// Function to find the label of a vertex
+
+const char *vertex_label(NETWORK *network, int i)
+{
+  if ((network->label==NULL)||(network->label[i]<0)) return NULL;
+  return network->labels + network->label[i];
+}
@@ -11,6 +11,9 @@
 #include "network.h"
 
 int read_network(NETWORK *network, FILE *stream);
+int read_network_threads(NETWORK *network, FILE *stream, int nthreads);
 void free_network(NETWORK *network);
+void free_edges(NETWORK *network);
+const char *vertex_label(NETWORK *network, int i);
 
 #endif
@@ -0,0 +1,77 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Reading a network in any of the supported input formats
+//
+// Function calls:
+//   int network_format(const char *name)
+//     -- Returns the FORMAT_ constant for a format name given on the
+//        command line ("gml", "edgelist", "snap", "mtx" or "snapshot"),
+//        or -1 if the name is not known
+//   int read_any_network(NETWORK *network, FILE *stream, const char *filename,
+//                        int format, int nthreads)
+//     -- Reads a network in the given format from "stream", using up to
+//        "nthreads" parser threads (0 means one per online processor).
+//        With FORMAT_AUTO the format is worked out from the snapshot magic
+//        number, then the extension of "filename" (which may be NULL),
+//        then the first line of the text.  Returns 0 if read was
+//        successful.
+//   int read_networks(LOADJOB job[], int njobs, int nthreads)
+//     -- Reads the files of several jobs at once, from a pool of loader
+//        threads, using up to "nthreads" threads in all (0 means one per
+//        online processor).  Returns 0 if every file was read.
+//
+// The readers keep all their state in the structures of the call, so any
+// number of networks may be read at the same time from different threads.
+// read_networks starts the largest files first and gives each load a
+// share of the threads in proportion to the size of its file, so a batch
+// takes about as long as its largest file.
+
+#ifndef READNET_H
+#define READNET_H
+
+#include <stdio.h>
+#include "network.h"
+
+// Input formats
+
+enum { FORMAT_AUTO, FORMAT_GML, FORMAT_EDGELIST, FORMAT_SNAP, FORMAT_MTX, FORMAT_SNAPSHOT };
+
+// Types
+
+typedef struct {
+  const char *filename;  // File to read
+  int format;            // Its FORMAT_ constant, FORMAT_AUTO to work it out
+  NETWORK network;       // Network read from the file
+  int result;            // 0 if the network was read successfully
+} LOADJOB;
+
+int network_format(const char *name);
+int read_any_network(NETWORK *network, FILE *stream, const char *filename,
+                     int format, int nthreads);
+int read_networks(LOADJOB job[], int njobs, int nthreads);
+
+#endif
@@ -0,0 +1,132 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Graphs shared between processes
+//
+// Several runs of the algorithms on the same network each load it and
+// hold their own copy.  Instead, one process can publish the CSR form of
+// the network, as the algorithms use it, in a named shared-memory
+// segment, and later processes can attach to the segment and run on it
+// without loading or copying anything: the arrays of their CSR graph point
+// into a read-only mapping of the segment, so all of them share one copy
+// in memory.
+//
+// A name that starts with "/" and has no other "/" is a POSIX shared
+// memory object (on Linux, a file in /dev/shm).  Any other name is a path,
+// for instance of a file on a hugetlbfs mount, which puts the segment on
+// huge pages.  The segment outlives the process that published it, until
+// it is removed (e.g. "rm /dev/shm/<name>") or the machine restarts.
+//
+// The segment holds, each section on an 8-byte boundary:
+//
+//   SHARED_HEADER       fixed-size header, see below
+//   offsets             (nvertices+1) x uint32
+//   targets             nentries x uint32, unless the lists are packed
+//   weights             nentries weights of the width of weighttype
+//   packed lists        packedlength bytes and (nvertices+1) x uint64
+//                       offsets, if the lists are packed (see "csr.h")
+//   in-edges            the same five sections again for the reverse of
+//                       a directed graph, if it was built
+//   perm                nvertices x uint32, if the vertices were reordered
+//                       (see "reorder.h")
+//   ids                 nvertices x int64
+//   labels              nvertices x int64 offsets and the text, if the
+//                       network has labels
+//
+// The header is written last, so a process never attaches to a segment
+// that is still being filled in.  Numbers are in the byte order of the
+// machine, which is checked.
+//
+// Function calls:
+//   int publish_graph(const char *name, NETWORK *network, CSR *graph,
+//                     const uint32_t perm[], int hugepages)
+//     -- Writes "graph" and its in-edges, the ids and labels of "network"
+//        and the vertex order "perm" (NULL if the vertices were not
+//        reordered) to the segment "name", replacing any segment of that
+//        name.  With "hugepages" the segment is advised to use
+//        transparent huge pages.  Returns 0 if successful
+//   int attach_graph(const char *name, NETWORK *network, CSR *graph,
+//                    uint32_t **perm)
+//     -- Maps the segment "name" and points "graph" at it.  "network" is
+//        given the vertices, with their ids, degrees and labels but no
+//        edges, "graph" its in-edges if they were published, and *perm a
+//        copy of the vertex order (NULL if there is none).  free_csr()
+//        unmaps the segment and free_network() frees the network as
+//        usual.  Returns 0 if successful, 1 if the segment cannot be
+//        mapped, is not a complete graph for this machine, or memory runs
+//        out
+
+#ifndef SHAREDGRAPH_H
+#define SHAREDGRAPH_H
+
+#include <stdint.h>
+#include "network.h"
+#include "csr.h"
+
+#define SHARED_MAGIC "KPATHSHM"
+#define SHARED_VERSION 3
+#define SHARED_BYTEORDER 0x01020304
+
+// Flags
+
+#define SHARED_DIRECTED 1        // Network is directed
+#define SHARED_PACKED 2          // Neighbor lists are packed
+#define SHARED_PERMUTED 4        // Segment has a perm section
+#define SHARED_LABELED 8         // Segment has a labels section
+#define SHARED_REVERSED 16       // Segment has the in-edges
+
+// Sections.  Those of the in-edges are SECTION_REVERSE on from the ones
+// of the graph: SECTION_REVERSE+SECTION_OFFSETS and so on.
+
+enum { SECTION_OFFSETS, SECTION_TARGETS, SECTION_WEIGHTS, SECTION_PACKED,
+       SECTION_PACKEDOFFSETS, SECTION_REVERSE, SECTION_PERM=2*SECTION_REVERSE,
+       SECTION_IDS, SECTION_LABELS, SECTION_TEXT, NSECTIONS };
+
+typedef struct {
+  char magic[8];         // SHARED_MAGIC, not NUL-terminated.  Written last
+  uint32_t version;      // SHARED_VERSION
+  uint32_t byteorder;    // SHARED_BYTEORDER as written by the publisher
+  uint32_t flags;        // SHARED_ flags
+  int32_t weighttype;    // WEIGHTS_ type of the CSR graph
+  uint64_t nvertices;    // Number of vertices
+  uint64_t nedges;       // Number of edges, as in NETWORK
+  uint64_t nentries;     // Number of adjacency entries, nedges of the CSR
+  uint64_t packedlength; // Bytes of packed lists
+  uint64_t rpackedlength; // Bytes of packed lists of the in-edges
+  uint64_t textlength;   // Bytes of label text
+  uint64_t length;       // Bytes of the whole segment
+  double weight;         // weight and max_weight of the CSR graph
+  double max_weight;
+  double max_network;    // MAX_Weight and MIN_Weight of the network
+  double min_network;
+  uint64_t section[NSECTIONS];  // Start of each section, 0 if absent
+} SHARED_HEADER;
+
+int publish_graph(const char *name, NETWORK *network, CSR *graph,
+                  const uint32_t perm[], int hugepages);
+int attach_graph(const char *name, NETWORK *network, CSR *graph, uint32_t **perm);
+
+#endif
@@ -0,0 +1,276 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Removal of duplicate edges and self-loops.  See "simplify.h".
+
+#include <stdlib.h>
+#include <stdint.h>
+#include <string.h>
+#include <pthread.h>
+#include "simplify.h"
+#include "loader.h"
+
+// Types
+
+typedef struct {
+  int owner;           // Vertex whose edges led here, or -1 if never used
+  int target;          // The neighbor
+  int slot;            // Where its edge was kept
+} SEEN;
+
+typedef struct {
+  NETWORK *network;
+  int first,last;      // Range of vertices handled by this part
+  int duplicates;      // Policies
+  int selfloops;
+  SEEN *seen;          // Neighbors seen, by hash with linear probing
+  uint64_t size;       // Size of the table, twice the largest degree or more
+  int shift;           // 64 less the bits of the size
+  long loops;          // Self-loop entries removed
+  long repeats;        // Repeated entries removed
+} PART;
+
+
+// Function to clean the edges of one vertex in place.  Only the first
+// self-loop is kept when duplicates are removed; in an undirected network
+// that is its first two entries, one for each end.  The neighbors seen are
+// looked up in the table of the part, whose entries count only for the
+// vertex that owns them, so it need not be cleared between vertices.
+
+void simplify_vertex(PART *part, int u)
+{
+  int j,n,v;
+  int per,nloops=0;
+  int loopslot[2];
+  uint64_t k;
+  SEEN *seen = part->seen;
+  double w,loopsum=0;
+  EDGE *edge = part->network->vertex[u].edge;
+  int degree = part->network->vertex[u].degree;
+
+  per = part->network->directed ? 1 : 2;
+  n = 0;
+  for (j=0; j<degree; j++) {
+    v = edge[j].target;
+    w = edge[j].weight;
+
+    if (v==u) {
+      if (part->selfloops==SELFLOOPS_DROP) {
+        part->loops++;
+        continue;
+      }
+      loopsum += w;
+      if ((part->duplicates!=DUPLICATES_KEEP)&&(nloops==per)) {
+        part->repeats++;
+        continue;
+      }
+      if (nloops<per) loopslot[nloops] = n;
+      nloops++;
+    } else if (part->duplicates!=DUPLICATES_KEEP) {
+      k = ((uint64_t) v*0x9E3779B97F4A7C15ULL) >> part->shift;
+      while ((seen[k].owner==u)&&(seen[k].target!=v)) k = (k+1) & (part->size-1);
+      if (seen[k].owner==u) {
+        part->repeats++;
+        if (part->duplicates==DUPLICATES_SUM) edge[seen[k].slot].weight += w;
+        continue;
+      }
+      seen[k].owner = u;
+      seen[k].target = v;
+      seen[k].slot = n;
+    }
+    edge[n++] = edge[j];
+  }
+
+  // Every end of the kept self-loop carries the weight of all of them
+
+  if ((part->duplicates==DUPLICATES_SUM)&&(nloops>0)) {
+    for (j=0; j<per; j++) edge[loopslot[j]].weight = loopsum/per;
+  }
+
+  part->network->vertex[u].degree = n;
+}
+
+
+// Thread function to clean the edges of a range of vertices
+
+void *simplify_part(void *arg)
+{
+  int u;
+  PART *part = (PART*) arg;
+
+  for (u=part->first; u<part->last; u++) simplify_vertex(part,u);
+  return NULL;
+}
+
+
+// Function to close the gaps left in the edge block, so that the edges of
+// each vertex follow straight on from those of the one before, and to
+// recompute the largest and smallest weights
+
+void compact_edges(NETWORK *network)
+{
+  int i,j;
+  size_t n=0;
+  EDGE *edges;
+
+  network->MAX_Weight = 1;
+  network->MIN_Weight = 1;
+  for (i=0; i<network->nvertices; i++) {
+    for (j=0; j<network->vertex[i].degree; j++) {
+      if (network->MAX_Weight<network->vertex[i].edge[j].weight)
+        network->MAX_Weight = network->vertex[i].edge[j].weight;
+      if (network->MIN_Weight>network->vertex[i].edge[j].weight)
+        network->MIN_Weight = network->vertex[i].edge[j].weight;
+    }
+  }
+
+  if (network->edges==NULL) return;
+
+  for (i=0; i<network->nvertices; i++) {
+    memmove(network->edges+n,network->vertex[i].edge,network->vertex[i].degree*sizeof(EDGE));
+    n += network->vertex[i].degree;
+  }
+
+  // Give the space back.  The block may move, so the vertices are pointed
+  // at their edges afterwards.
+
+  edges = (EDGE*) realloc(network->edges,(n>0 ? n : 1)*sizeof(EDGE));
+  if (edges!=NULL) network->edges = edges;
+  n = 0;
+  for (i=0; i<network->nvertices; i++) {
+    network->vertex[i].edge = network->edges + n;
+    n += network->vertex[i].degree;
+  }
+}
+
+
+// Function to apply the policies to a network
+
+int simplify_network(NETWORK *network, int duplicates, int selfloops,
+                     int nthreads, SIMPLIFY_REPORT *report)
+{
+  int i,p,nparts,maxdegree;
+  int per,result=0;
+  size_t total,done;
+  PART *parts;
+  pthread_t *threads;
+
+  report->selfloops = 0;
+  report->duplicates = 0;
+  if ((duplicates==DUPLICATES_KEEP)&&(selfloops==SELFLOOPS_KEEP)) return 0;
+
+  nparts = thread_count(nthreads);
+  if (nparts>network->nvertices) nparts = network->nvertices;
+  if (nparts<1) nparts = 1;
+  parts = (PART*) calloc(nparts,sizeof(PART));
+  threads = (pthread_t*) calloc(nparts,sizeof(pthread_t));
+  if ((parts==NULL)||(threads==NULL)) result = 1;
+
+  // Split the vertices into parts with about the same number of edges
+
+  total = 0;
+  for (i=0; i<network->nvertices; i++) total += network->vertex[i].degree;
+  done = 0;
+  i = 0;
+  for (p=0; (p<nparts)&&(result==0); p++) {
+    parts[p].network = network;
+    parts[p].duplicates = duplicates;
+    parts[p].selfloops = selfloops;
+    parts[p].first = i;
+    maxdegree = 0;
+    while ((i<network->nvertices)&&((p==nparts-1)||(done<total/nparts*(p+1)))) {
+      if (maxdegree<network->vertex[i].degree) maxdegree = network->vertex[i].degree;
+      done += network->vertex[i++].degree;
+    }
+    parts[p].last = i;
+
+    // The table holds the neighbors of one vertex at a time, so it only
+    // needs to be twice the largest degree in the part
+
+    if (duplicates!=DUPLICATES_KEEP) {
+      parts[p].size = 2;
+      parts[p].shift = 63;
+      while (parts[p].size<2*(uint64_t) maxdegree) {
+        parts[p].size *= 2;
+        parts[p].shift--;
+      }
+      parts[p].seen = (SEEN*) malloc(parts[p].size*sizeof(SEEN));
+      if (parts[p].seen==NULL) result = 1;
+      else memset(parts[p].seen,-1,parts[p].size*sizeof(SEEN));
+    }
+  }
+
+  // Run the parts, the first one on the calling thread
+
+  if (result==0) {
+    for (p=1; p<nparts; p++) {
+      if (pthread_create(&threads[p],NULL,simplify_part,&parts[p])!=0) {
+        threads[p] = 0;
+        simplify_part(&parts[p]);
+      }
+    }
+    simplify_part(&parts[0]);
+    for (p=1; p<nparts; p++) {
+      if (threads[p]!=0) pthread_join(threads[p],NULL);
+    }
+
+    // Both ends of an undirected edge were counted
+
+    per = network->directed ? 1 : 2;
+    for (p=0; p<nparts; p++) {
+      report->selfloops += parts[p].loops/per;
+      report->duplicates += parts[p].repeats/per;
+    }
+    network->nedges -= report->selfloops + report->duplicates;
+    compact_edges(network);
+  }
+
+  if (parts!=NULL) {
+    for (p=0; p<nparts; p++) free(parts[p].seen);
+  }
+  free(parts);
+  free(threads);
+
+  return result;
+}
+
+
+// Functions to look up the policy names
+
+int duplicates_policy(const char *name)
+{
+  if (strcmp(name,"keep")==0) return DUPLICATES_KEEP;
+  if (strcmp(name,"drop")==0) return DUPLICATES_DROP;
+  if (strcmp(name,"sum")==0) return DUPLICATES_SUM;
+  return -1;
+}
+
+int selfloops_policy(const char *name)
+{
+  if (strcmp(name,"keep")==0) return SELFLOOPS_KEEP;
+  if (strcmp(name,"drop")==0) return SELFLOOPS_DROP;
+  return -1;
+}
@@ -0,0 +1,350 @@
+/*
+
+Copyright (c) 2014, Nicolas Kourtellis (extensions)
+
+Copyright (c) 2012, Tharaka Alahakoon, Rahul Tripathi, Nicolas Kourtellis
+
+Permission is hereby granted, free of charge, to any person obtaining a copy
+of this software and associated documentation files (the "Software"), to deal
+in the Software without restriction, including without limitation the rights
+to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+copies of the Software, and to permit persons to whom the Software is
+furnished to do so, subject to the following conditions:
+
+The above copyright notice and this permission notice shall be included in
+all copies or substantial portions of the Software.
+
+THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+THE SOFTWARE.
+
+*/
+
+// Functions to write and read binary snapshots of a network.  See
+// "snapshot.h" for the file layout.
+
+#include <stdlib.h>
+#include <string.h>
+#include <limits.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include "snapshot.h"
+
+// Constants
+
+#define BLOCKLENGTH 65536
+
+// Types
+
+typedef struct {
+  FILE *stream;              // Stream the snapshot is written to
+  size_t fill;               // Number of bytes waiting in block
+  int error;                 // Set once a write has failed
+  char block[BLOCKLENGTH];   // Output block buffer
+} WRITER;
+
+
+// Function to round the length of a section up to a multiple of 8 bytes
+
+size_t section_length(size_t length)
+{
+  return (length+7) & ~((size_t) 7);
+}
+
+
+// Function to write the buffered bytes out to the stream
+
+void flush_block(WRITER *writer)
+{
+  if ((writer->fill>0)&&(fwrite(writer->block,1,writer->fill,writer->stream)!=writer->fill))
+    writer->error = 1;
+  writer->fill = 0;
+}
+
+
+// Function to append bytes to the output, going through the block buffer
+
+void put_bytes(WRITER *writer, const void *data, size_t length)
+{
+  if (writer->fill+length>BLOCKLENGTH) flush_block(writer);
+  if (length>BLOCKLENGTH) {
+    if (fwrite(data,1,length,writer->stream)!=length) writer->error = 1;
+    return;
+  }
+  memcpy(writer->block+writer->fill,data,length);
+  writer->fill += length;
+}
+
+
+// Function to pad the output to the end of a section of "length" bytes
+
+void put_padding(WRITER *writer, size_t length)
+{
+  static const char zero[8] = { 0, 0, 0, 0, 0, 0, 0, 0 };
+  put_bytes(writer,zero,section_length(length)-length);
+}
+
+
+// Function to write a network to a stream as a snapshot.  Weights are only
+// written when the network is weighted, i.e. when MAX_Weight or
+// MIN_Weight differ from 1.  Returns 0 if successful, otherwise 1.
+
+int write_snapshot(NETWORK *network, FILE *stream)
+{
+  int i,j;
+  int weighted;
+  uint32_t target;
+  uint64_t offset,labellength;
+  int64_t id;
+  SNAPSHOT_HEADER header;
+  WRITER *writer;
+
+  writer = (WRITER*) malloc(sizeof(WRITER));
+  if (writer==NULL) return 1;
+  writer->stream = stream;
+  writer->fill = 0;
+  writer->error = 0;
+
+  weighted = (network->MAX_Weight!=1)||(network->MIN_Weight!=1);
+
+  // Header
+
+  memset(&header,0,sizeof(header));
+  memcpy(header.magic,SNAPSHOT_MAGIC,8);
+  header.version = SNAPSHOT_VERSION;
+  header.byteorder = SNAPSHOT_BYTEORDER;
+  header.flags = (network->directed ? SNAPSHOT_DIRECTED : 0)
+                 | (weighted ? SNAPSHOT_WEIGHTED : 0)
+                 | ((network->label!=NULL) ? SNAPSHOT_LABELED : 0);
+  header.targetwidth = sizeof(uint32_t);
+  header.nvertices = network->nvertices;
+  header.nedges = network->nedges;
+  header.nentries = 0;
+  for (i=0; i<network->nvertices; i++) header.nentries += network->vertex[i].degree;
+  header.max_weight = network->MAX_Weight;
+  header.min_weight = network->MIN_Weight;
+  put_bytes(writer,&header,sizeof(header));
+
+  // Offsets
+
+  offset = 0;
+  put_bytes(writer,&offset,sizeof(offset));
+  for (i=0; i<network->nvertices; i++) {
+    offset += network->vertex[i].degree;
+    put_bytes(writer,&offset,sizeof(offset));
+  }
+
+  // Targets
+
+  for (i=0; i<network->nvertices; i++) {
+    for (j=0; j<network->vertex[i].degree; j++) {
+      target = network->vertex[i].edge[j].target;
+      put_bytes(writer,&target,sizeof(target));
+    }
+  }
+  put_padding(writer,header.nentries*sizeof(uint32_t));
+
+  // Weights
+
+  if (weighted) {
+    for (i=0; i<network->nvertices; i++) {
+      for (j=0; j<network->vertex[i].degree; j++)
+        put_bytes(writer,&network->vertex[i].edge[j].weight,sizeof(double));
+    }
+  }
+
+  // IDs
+
+  for (i=0; i<network->nvertices; i++) {
+    id = network->vertex[i].id;
+    put_bytes(writer,&id,sizeof(id));
+  }
+
+  // Labels.  The text runs up to the end of the label that ends last.
+
+  if (network->label!=NULL) {
+    labellength = 0;
+    for (i=0; i<network->nvertices; i++) {
+      id = network->label[i];
+      put_bytes(writer,&id,sizeof(id));
+      if ((id>=0)&&(id+strlen(network->labels+id)+1>labellength))
+        labellength = id + strlen(network->labels+id) + 1;
+    }
+    put_bytes(writer,&labellength,sizeof(labellength));
+    put_bytes(writer,network->labels,labellength);
+    put_padding(writer,labellength);
+  }
+
+  flush_block(writer);
+  i = writer->error;
+  free(writer);
+
+  return i;
+}
+
+
+// Function to check whether the file behind a stream is a snapshot.  The
+// header is read with pread(), so the stream is left untouched.
+
+int is_snapshot(FILE *stream)
+{
+  long offset;
+  char magic[8];
+
+  offset = ftell(stream);
+  if (offset<0) return 0;
+  if (pread(fileno(stream),magic,8,offset)!=8) return 0;
+
+  return memcmp(magic,SNAPSHOT_MAGIC,8)==0;
+}
+
+
+// Function to read a snapshot into a network.  The file is mapped into
+// memory and the vertex and edge arrays are filled straight from the
+// mapped sections.  Returns 1 if the file cannot be mapped, is not a valid
+// snapshot for this machine, or memory runs out, otherwise 0.
+
+int read_snapshot(NETWORK *network, FILE *stream)
+{
+  int valid;
+  long offset;
+  size_t length,needed;
+  uint64_t i,n,m;
+  void *map;
+  const char *base;
+  const SNAPSHOT_HEADER *header;
+  const uint64_t *offsets;
+  const uint32_t *targets;
+  const double *weights;
+  const int64_t *ids;
+  const int64_t *labels;
+  const char *text;
+  uint64_t textlength;
+  struct stat info;
+
+  network->nvertices = 0;
+  network->vertex = NULL;
+  network->edges = NULL;
+  network->labels = NULL;
+  network->label = NULL;
+
+  // Map the file
+
+  offset = ftell(stream);
+  if ((offset<0)||(fstat(fileno(stream),&info)!=0)) return 1;
+  if ((size_t) info.st_size<offset+sizeof(SNAPSHOT_HEADER)) return 1;
+  map = mmap(NULL,info.st_size,PROT_READ,MAP_PRIVATE,fileno(stream),0);
+  if (map==MAP_FAILED) return 1;
+  madvise(map,info.st_size,MADV_SEQUENTIAL);
+  base = (const char*) map + offset;
+  length = info.st_size - offset;
+
+  // Check the header and find the sections
+
+  header = (const SNAPSHOT_HEADER*) base;
+  n = header->nvertices;
+  m = header->nentries;
+  if ((memcmp(header->magic,SNAPSHOT_MAGIC,8)!=0)||(header->version!=SNAPSHOT_VERSION)
+      ||(header->byteorder!=SNAPSHOT_BYTEORDER)||(header->targetwidth!=sizeof(uint32_t))
+      ||(n>INT_MAX)||(m>(uint64_t) length)) {
+    munmap(map,info.st_size);
+    return 1;
+  }
+
+  offsets = (const uint64_t*) (base + sizeof(SNAPSHOT_HEADER));
+  targets = (const uint32_t*) (offsets + n + 1);
+  weights = (const double*) ((const char*) targets + section_length(m*sizeof(uint32_t)));
+  if (header->flags&SNAPSHOT_WEIGHTED) ids = (const int64_t*) (weights + m);
+  else {
+    ids = (const int64_t*) weights;
+    weights = NULL;
+  }
+  needed = (const char*) (ids + n) - base;
+  labels = NULL;
+  text = NULL;
+  textlength = 0;
+  if ((header->flags&SNAPSHOT_LABELED)&&(needed+(n+1)*sizeof(int64_t)<=length)) {
+    labels = ids + n;
+    textlength = *(const uint64_t*) (labels + n);
+    text = (const char*) (labels + n + 1);
+    if (textlength>length) textlength = length;
+    needed = (text + textlength) - base;
+  }
+  if ((needed>length)||(offsets[n]!=m)
+      ||((header->flags&SNAPSHOT_LABELED)&&(labels==NULL))
+      ||((textlength>0)&&(text[textlength-1]!='\0'))) {
+    munmap(map,info.st_size);
+    return 1;
+  }
+
+  // Fill the network
+
+  network->directed = (header->flags&SNAPSHOT_DIRECTED) ? 1 : 0;
+  network->nedges = (int) header->nedges;
+  network->MAX_Weight = header->max_weight;
+  network->MIN_Weight = header->min_weight;
+  network->vertex = (VERTEX*) calloc(n,sizeof(VERTEX));
+  network->edges = (EDGE*) malloc(m*sizeof(EDGE));
+  if (labels!=NULL) {
+    network->label = (long*) malloc((n>0 ? n : 1)*sizeof(long));
+    network->labels = (char*) malloc(textlength>0 ? textlength : 1);
+  }
+  if (((network->vertex==NULL)&&(n>0))||((network->edges==NULL)&&(m>0))
+      ||((labels!=NULL)&&((network->label==NULL)||(network->labels==NULL)))) {
+    free(network->vertex);
+    free(network->edges);
+    free(network->label);
+    free(network->labels);
+    network->vertex = NULL;
+    network->edges = NULL;
+    network->label = NULL;
+    network->labels = NULL;
+    munmap(map,info.st_size);
+    return 1;
+  }
+  network->nvertices = (int) n;
+
+  valid = 1;
+  for (i=0; i<n; i++) {
+    if ((offsets[i]>offsets[i+1])||(offsets[i+1]>m)) valid = 0;
+    network->vertex[i].id = ids[i];
+    network->vertex[i].degree = (int) (offsets[i+1]-offsets[i]);
+    network->vertex[i].edge = network->edges + offsets[i];
+  }
+  for (i=0; i<m; i++) {
+    if (targets[i]>=n) valid = 0;
+    network->edges[i].target = targets[i];
+    network->edges[i].weight = (weights==NULL) ? 1.0 : weights[i];
+  }
+  if (labels!=NULL) {
+    memcpy(network->labels,text,textlength);
+    for (i=0; i<n; i++) {
+      if ((labels[i]<-1)||(labels[i]>=(int64_t) textlength)) valid = 0;
+      network->label[i] = labels[i];
+    }
+  }
+
+  munmap(map,info.st_size);
+
+  // Reject snapshots with inconsistent offsets or targets
+
+  if (!valid) {
+    free(network->vertex);
+    free(network->edges);
+    free(network->label);
+    free(network->labels);
+    network->vertex = NULL;
+    network->edges = NULL;
+    network->label = NULL;
+    network->labels = NULL;
+    network->nvertices = 0;
+    return 1;
+  }
+
+  return 0;
+}
@@ -1,75 +1,397 @@
+// Converter of edge lists to the formats read by kpath_centrality
+//
+// The edge list is read in a single streaming pass, through the readers of
+// ../kpath-code, so it may be a memory-mapped file, a pipe or a .gz/.zst
+// file.  Lines hold "node1 node2 [weight]"; lines starting with # or % are
+// comments.  Node IDs may be any 64-bit integers: the distinct IDs are kept
+// in a hash set, so memory grows with the number of nodes and not with the
+// size of the largest ID.  Output goes through a large buffer, with the
+// numbers formatted by hand and weights copied as they were written.
+//
+// GML output lists the edges as they are read and the nodes, in order of
+// first appearance, at the end of the graph.  Snapshot output (see
+// ../kpath-code/snapshot.h) builds the whole network in memory first.
+//
+// With --batch every file given is converted to a snapshot next to it,
+// named after it with the extension .csr.  The files are read at the same
+// time by the loader pool of ../kpath-code/readnet.h, so a batch takes
+// about as long as its largest file.
+
 #include <stdlib.h>
 #include <stdio.h>
 #include <string.h>
 #include <vector>
+#include <string>
+#include "loader.h"
+#include "bytescan.h"
+#include "readgml.h"
+#include "readnet.h"
+#include "snapshot.h"
 using namespace std;
 
+#define OUTPUTLENGTH (1<<20)
+
+enum { OUTPUT_GML, OUTPUT_EDGELIST, OUTPUT_SNAPSHOT };
+
+// Set of the node IDs seen so far, with open addressing and linear probing.
+// It is kept at most half full.
+typedef struct {
+	vector < long long > key;
+	vector < char > used;
+	vector < long long > order;		// IDs in order of first appearance
+	int shift;
+} IDSET;
+
+// Buffered output
+typedef struct {
+	FILE *stream;
+	char *buffer;
+	size_t len;
+	int error;
+} OUTPUT;
+
+void idset_init(IDSET *set, int bits);
+void idset_add(IDSET *set, long long id);
+void put_flush(OUTPUT *out);
+void put_text(OUTPUT *out, const char *text, size_t len);
+void put_id(OUTPUT *out, long long id);
+int output_format(const char *name, const char *filename);
+int batch_snapshots(char *files[], int nfiles, int directed);
+
 //Main
 int main(int argc, char *argv[]) {
-	int i, j, k;
-	int nvertices = 0, nedges = 0;
-	vector < int > nodes;
+	int n = 1, i, format = -1, directed = 0, batch = 0;
+	long long s, t, line = 0, nedges = 0;
+	long value;
+	const char *p, *q, *start, *stop, *end, *weight, *weightEnd;
+	char *args[3];
+	vector < char * > inputs;
 	FILE *ptrRead, *ptrWrite;
-	
-	// Check command-line arguments 
-	if (argc < 3) { 
-		printf( "Usage: ./FileToGML <infile.txt> <outfile.gml>\nNote: the infile.txt must have lines with 3 space-separated columns:\nnode1 node2 weight\n" );
-		return 0; 
+	READER reader;
+	OUTPUT out;
+	IDSET nodes;
+	NETWORK network;
+
+	// Separate the options from the file names
+	for (i = 1; i < argc; i++) {
+		if ((strcmp(argv[i], "--to") == 0) && (i + 1 < argc)) {
+			format = output_format(argv[++i], NULL);
+			if (format < 0) {
+				printf( "Unknown output format %s (use gml, edgelist or snapshot)\n", argv[i] );
+				return 1;
+			}
+		}
+		else if (strcmp(argv[i], "--directed") == 0)
+			directed = 1;
+		else if (strcmp(argv[i], "--batch") == 0)
+			batch = 1;
+		else if (strncmp(argv[i], "--", 2) != 0)
+			inputs.push_back(argv[i]);
+		else
+			n = 0;
 	}
+	for (i = 0; (n > 0) && !batch && (i < (int) inputs.size()); i++) {
+		if (n < 3)
+			args[n++] = inputs[i];
+		else
+			n = 0;
+	}
+
+	// Convert a batch of files to snapshots, reading them all at once
+	if (batch && (n > 0) && ((format < 0) || (format == OUTPUT_SNAPSHOT)) && !inputs.empty())
+		return batch_snapshots(&inputs[0], (int) inputs.size(), directed);
+
+	// Check command-line arguments
+	if (n != 3) {
+		printf( "Usage: ./fileToGML [--to gml|edgelist|snapshot] [--directed] <infile.txt> <outfile>\n" );
+		printf( "       ./fileToGML --batch [--directed] <infile.txt>...\n" );
+		printf( "Note: the infile.txt must have lines with 2 or 3 space-separated columns:\nnode1 node2 [weight]\n" );
+		printf( "The output format is taken from the extension of outfile (.gml, .txt or .csr) unless --to is given\n" );
+		printf( "With --batch each infile is converted to a snapshot named after it, with the extension .csr\n" );
+		return 0;
+	}
+	if (format < 0)
+		format = output_format(NULL, args[2]);
 
 	//Open the read file
-	ptrRead = fopen( argv[1], "r" );
+	ptrRead = fopen( args[1], "r" );
 	if( ptrRead == NULL ) {
 		printf( "Unable to open the data file.\n" );
-		return 0;
+		return 1;
 	}
 
 	//Open the write file
-	ptrWrite = fopen( argv[2], "w" );
-	if( ptrRead == NULL ) {
+	ptrWrite = fopen( args[2], "wb" );
+	if( ptrWrite == NULL ) {
 		printf( "Unable to open the write file.\n" );
+		return 1;
+	}
+
+	// Snapshots need the whole network, so use the network readers
+	if (format == OUTPUT_SNAPSHOT) {
+		if (read_any_network(&network, ptrRead, args[1], directed ? FORMAT_SNAP : FORMAT_EDGELIST, 0) != 0) {
+			printf( "Unable to read the data file.\n" );
+			return 1;
+		}
+		if (write_snapshot(&network, ptrWrite) != 0) {
+			printf( "Unable to write the snapshot.\n" );
+			return 1;
+		}
+		printf( "snapshot created successfully: %d nodes, %d edges\n", network.nvertices, network.nedges );
+		free_network(&network);
+		fclose( ptrRead );
+		fclose( ptrWrite );
 		return 0;
 	}
-	fprintf( ptrWrite, "GML file created from file " );
-	fprintf( ptrWrite, "%s", argv[1] );
-	fprintf( ptrWrite, " to gml file\ngraph\n[\n" );
 
-	//Count number of vertices and edges
-	while( fscanf( ptrRead, "%i %i %i\n", &i, &j, &k) != EOF ) {
-		if( nvertices < i )
-			nvertices = i;
-		if( nvertices < j )
-			nvertices = j;
-		nedges++;
+	if (open_reader(&reader, ptrRead) != 0) {
+		printf( "Unable to read the data file.\n" );
+		return 1;
 	}
-	nodes.assign( nvertices + 1, 0 );
+	out.stream = ptrWrite;
+	out.buffer = (char*) malloc(OUTPUTLENGTH);
+	out.len = 0;
+	out.error = (out.buffer == NULL);
+	if (out.error) {
+		printf( "Out of memory.\n" );
+		return 1;
+	}
+	idset_init(&nodes, 16);
 
-	//Write all node id's to the gml file
-	rewind( ptrRead );
-	while( fscanf( ptrRead, "%i %i %i\n", &i, &j, &k) != EOF ) {
-		if( nodes[i] == 0 ) {
-			fprintf( ptrWrite, "  node\n  [\n    id %i\n  ]\n", i );
-			nodes[i] = 1;
+	if (format == OUTPUT_GML) {
+		put_text(&out, "GML file created from file ", 27);
+		put_text(&out, args[1], strlen(args[1]));
+		put_text(&out, " to gml file\ngraph\n[\n", 21);
+		if (directed)
+			put_text(&out, "  directed 1\n", 13);
+	}
+
+	// Read and write the edges, one line at a time
+	while (1) {
+		end = reader.text + reader.len;
+		start = reader.text + reader.pos;
+		stop = scan_char(start, end, '\n');
+		if ((stop == end) && (refill(&reader) > 0))
+			continue;
+		if (start == end)
+			break;
+		reader.pos = stop - reader.text;
+		if (stop < end)
+			reader.pos++;
+		line++;
+
+		p = scan_space(start, stop);
+		if ((p == stop) || (*p == '#') || (*p == '%'))
+			continue;
+
+		// node1 node2 [weight]
+		q = scan_delim(p, stop);
+		if (parse_int(p, q, &value) != 0) {
+			printf( "Line %lld of the data file is not an edge.\n", line );
+			return 1;
 		}
-		if( nodes[j] == 0 ) {
-			fprintf( ptrWrite, "  node\n  [\n    id %i\n  ]\n", j );
-			nodes[j] = 1;
+		s = value;
+		p = scan_space(q, stop);
+		q = scan_delim(p, stop);
+		if ((p == stop) || (parse_int(p, q, &value) != 0)) {
+			printf( "Line %lld of the data file is not an edge.\n", line );
+			return 1;
+		}
+		t = value;
+		weight = scan_space(q, stop);
+		weightEnd = scan_delim(weight, stop);
+		if ((weight < stop) && ((*weight == '#') || (*weight == '%')))
+			weightEnd = weight;
+
+		idset_add(&nodes, s);
+		idset_add(&nodes, t);
+		nedges++;
+
+		if (format == OUTPUT_GML) {
+			put_text(&out, "  edge\n  [\n    source ", 22);
+			put_id(&out, s);
+			put_text(&out, "\n    target ", 12);
+			put_id(&out, t);
+			if (weightEnd > weight) {
+				put_text(&out, "\n    value ", 11);
+				put_text(&out, weight, weightEnd - weight);
+			}
+			put_text(&out, "\n  ]\n", 5);
+		} else {
+			put_id(&out, s);
+			put_text(&out, " ", 1);
+			put_id(&out, t);
+			if (weightEnd > weight) {
+				put_text(&out, " ", 1);
+				put_text(&out, weight, weightEnd - weight);
+			}
+			put_text(&out, "\n", 1);
 		}
 	}
 
-	//Write all edges to the gml file
-	rewind( ptrRead );
-	while( fscanf( ptrRead, "%i %i %i\n", &i, &j, &k) != EOF ) {
-		fprintf( ptrWrite, "  edge\n  [\n    source %i\n", i );
-		fprintf( ptrWrite, "    target %i\n    value %i\n  ]\n", j, k );
+	//Write all node id's to the gml file
+	if (format == OUTPUT_GML) {
+		for (size_t k = 0; k < nodes.order.size(); k++) {
+			put_text(&out, "  node\n  [\n    id ", 18);
+			put_id(&out, nodes.order[k]);
+			put_text(&out, "\n  ]\n", 5);
+		}
+		put_text(&out, "]\n", 2);
 	}
+	put_flush(&out);
 
 	//Close all files and release allocated memory
-	fprintf( ptrWrite, "]\n" );
+	close_reader(&reader);
 	fclose( ptrRead );
-	fclose( ptrWrite );
-	nodes.clear( );
-	printf( "gml file created successfully\n" );
+	if ((fclose( ptrWrite ) != 0) || out.error) {
+		printf( "Unable to write the output file.\n" );
+		return 1;
+	}
+	free(out.buffer);
+	printf( "%s file created successfully: %lu nodes, %lld edges\n", (format == OUTPUT_GML) ? "gml" : "edge list",
+		(unsigned long) nodes.order.size(), nedges );
 	return 0;
 }
 
+/*
+ * Output format from its name, or from the extension of the output file
+ */
+int output_format(const char *name, const char *filename) {
+	const char *dot;
+
+	if (name != NULL) {
+		if (strcmp(name, "gml") == 0) return OUTPUT_GML;
+		if (strcmp(name, "edgelist") == 0) return OUTPUT_EDGELIST;
+		if (strcmp(name, "snapshot") == 0) return OUTPUT_SNAPSHOT;
+		return -1;
+	}
+	dot = strrchr(filename, '.');
+	if (dot != NULL) {
+		if (strcmp(dot, ".csr") == 0) return OUTPUT_SNAPSHOT;
+		if ((strcmp(dot, ".txt") == 0) || (strcmp(dot, ".edges") == 0) || (strcmp(dot, ".el") == 0))
+			return OUTPUT_EDGELIST;
+	}
+	return OUTPUT_GML;
+}
+
+/*
+ * Convert a batch of edge lists to snapshots. All the files are read at once by the loader pool, then 
+ * each network is written next to its file, with the extension .csr in place of its own (and of .gz or .zst)
+ */
+int batch_snapshots(char *files[], int nfiles, int directed) {
+	int k, failed = 0;
+	size_t dot, slash;
+	FILE *ptrWrite;
+	vector < LOADJOB > jobs(nfiles);
+	string name;
+
+	for (k = 0; k < nfiles; k++) {
+		jobs[k].filename = files[k];
+		jobs[k].format = directed ? FORMAT_SNAP : FORMAT_EDGELIST;
+	}
+	read_networks(&jobs[0], nfiles, 0);
+
+	for (k = 0; k < nfiles; k++) {
+		if (jobs[k].result != 0) {
+			printf( "Unable to read the data file %s.\n", files[k] );
+			failed = 1;
+			continue;
+		}
+
+		// The name of the snapshot
+		name = files[k];
+		slash = name.rfind('/');
+		slash = (slash == string::npos) ? 0 : slash + 1;
+		dot = name.rfind('.');
+		if ((dot != string::npos) && (dot > slash) && ((name.compare(dot, string::npos, ".gz") == 0) || (name.compare(dot, string::npos, ".zst") == 0))) {
+			name.erase(dot);
+			dot = name.rfind('.');
+		}
+		if ((dot != string::npos) && (dot > slash))
+			name.erase(dot);
+		name += ".csr";
+
+		ptrWrite = fopen(name.c_str(), "wb");
+		if ((ptrWrite == NULL) || (write_snapshot(&jobs[k].network, ptrWrite) != 0) || (fclose(ptrWrite) != 0)) {
+			printf( "Unable to write the snapshot %s.\n", name.c_str() );
+			failed = 1;
+		} else
+			printf( "snapshot %s created successfully: %d nodes, %d edges\n", name.c_str(), jobs[k].network.nvertices, jobs[k].network.nedges );
+		free_network(&jobs[k].network);
+	}
+	return failed;
+}
+
+/*
+ * ID set with 2^bits slots
+ */
+void idset_init(IDSET *set, int bits) {
+	set->key.assign((size_t) 1 << bits, 0);
+	set->used.assign((size_t) 1 << bits, 0);
+	set->shift = 64 - bits;
+}
+
+/*
+ * Add an ID to the set if it is not there yet, doubling the table when it
+ * gets half full
+ */
+void idset_add(IDSET *set, long long id) {
+	size_t slot, mask = set->key.size() - 1;
+
+	slot = (size_t) (((unsigned long long) id * 0x9E3779B97F4A7C15ULL) >> set->shift);
+	while (set->used[slot]) {
+		if (set->key[slot] == id)
+			return;
+		slot = (slot + 1) & mask;
+	}
+	set->used[slot] = 1;
+	set->key[slot] = id;
+	set->order.push_back(id);
+
+	if (2 * set->order.size() > set->key.size()) {
+		idset_init(set, 65 - set->shift);
+		mask = set->key.size() - 1;
+		for (size_t k = 0; k < set->order.size(); k++) {
+			slot = (size_t) (((unsigned long long) set->order[k] * 0x9E3779B97F4A7C15ULL) >> set->shift);
+			while (set->used[slot])
+				slot = (slot + 1) & mask;
+			set->used[slot] = 1;
+			set->key[slot] = set->order[k];
+		}
+	}
+}
+
+/*
+ * Buffered output
+ */
+void put_flush(OUTPUT *out) {
+	if ((out->len > 0) && (fwrite(out->buffer, 1, out->len, out->stream) != out->len))
+		out->error = 1;
+	out->len = 0;
+}
+
+void put_text(OUTPUT *out, const char *text, size_t len) {
+	if (out->len + len > OUTPUTLENGTH)
+		put_flush(out);
+	if (len > OUTPUTLENGTH) {
+		if (fwrite(text, 1, len, out->stream) != len)
+			out->error = 1;
+		return;
+	}
+	memcpy(out->buffer + out->len, text, len);
+	out->len += len;
+}
+
+void put_id(OUTPUT *out, long long id) {
+	char digits[24];
+	int n = 24;
+	unsigned long long u = (id < 0) ? 0ULL - (unsigned long long) id : (unsigned long long) id;
+
+	do {
+		digits[--n] = '0' + (char) (u % 10);
+		u /= 10;
+	} while (u > 0);
+	if (id < 0)
+		digits[--n] = '-';
+	put_text(out, digits + n, 24 - n);
+}